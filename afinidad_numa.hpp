@@ -0,0 +1,204 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <omp.h>
+#include "configuracion.hpp"
+
+#if defined(__linux__)
+#include <dirent.h>
+#include <sched.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#define AFINIDAD_LINUX 1
+#endif
+
+// Ubicación de los hilos en máquinas con varios nodos NUMA (Linux).
+//
+// La topología se lee de /sys/devices/system/node; si no está (o no es
+// Linux) se toma un solo nodo con todas las CPU, y todo sigue funcionando
+// igual que sin afinidad.
+//
+// Las variables OMP_PLACES / OMP_PROC_BIND se leen cuando arranca el runtime
+// de OpenMP, antes de main, así que no se pueden fijar desde el programa. Si
+// vienen del entorno, manda el runtime y aquí solo se informa dónde quedó
+// cada hilo. Si no, con una política distinta de 'Ninguna' cada hilo se fija
+// a una CPU con sched_setaffinity al entrar a la región paralela; los hilos
+// del runtime se reutilizan, así que quedan fijos también en las regiones
+// siguientes.
+
+// "0-3,8,10-11" -> {0,1,2,3,8,10,11}
+inline std::vector<int> leerListaCpus(const std::string& texto) {
+    std::vector<int> cpus;
+    std::stringstream ss(texto);
+    std::string tramo;
+    while (std::getline(ss, tramo, ',')) {
+        if (tramo.empty() || tramo == "\n") continue;
+        size_t guion = tramo.find('-');
+        try {
+            int a = std::stoi(tramo.substr(0, guion));
+            int b = guion == std::string::npos ? a : std::stoi(tramo.substr(guion + 1));
+            for (int c = a; c <= b; c++) cpus.push_back(c);
+        } catch (const std::exception&) {
+            // tramo ilegible: se ignora
+        }
+    }
+    return cpus;
+}
+
+struct TopologiaNuma {
+    std::vector<std::vector<int>> cpusPorNodo;   // solo CPU permitidas al proceso
+    std::vector<int> idNodo;                     // número de nodo del sistema
+    std::vector<int> nodoDeCpu;                  // id del nodo; -1 si la CPU no está en ninguno
+
+    int numNodos() const { return (int)cpusPorNodo.size(); }
+
+    int nodo(int cpu) const {
+        return cpu >= 0 && cpu < (int)nodoDeCpu.size() ? nodoDeCpu[cpu] : 0;
+    }
+
+    static TopologiaNuma detectar() {
+        TopologiaNuma t;
+#ifdef AFINIDAD_LINUX
+        cpu_set_t permitidas;
+        CPU_ZERO(&permitidas);
+        bool hayMascara = sched_getaffinity(0, sizeof(permitidas), &permitidas) == 0;
+        auto permitida = [&](int c) { return !hayMascara || (c < CPU_SETSIZE && CPU_ISSET(c, &permitidas)); };
+
+        std::vector<std::pair<int, std::vector<int>>> nodos;
+        if (DIR* dir = opendir("/sys/devices/system/node")) {
+            while (dirent* e = readdir(dir)) {
+                std::string nombre = e->d_name;
+                if (nombre.compare(0, 4, "node") != 0 || nombre.size() == 4) continue;
+                if (nombre.find_first_not_of("0123456789", 4) != std::string::npos) continue;
+                std::ifstream f("/sys/devices/system/node/" + nombre + "/cpulist");
+                std::string lista;
+                std::getline(f, lista);
+                std::vector<int> cpus;
+                for (int c : leerListaCpus(lista))
+                    if (permitida(c)) cpus.push_back(c);
+                if (!cpus.empty()) nodos.push_back({std::stoi(nombre.substr(4)), cpus});
+            }
+            closedir(dir);
+        }
+        std::sort(nodos.begin(), nodos.end());
+        for (auto& n : nodos) {
+            t.idNodo.push_back(n.first);
+            t.cpusPorNodo.push_back(n.second);
+        }
+
+        if (t.cpusPorNodo.empty()) {
+            std::vector<int> todas;
+            for (int c = 0; c < CPU_SETSIZE; c++)
+                if (hayMascara && CPU_ISSET(c, &permitidas)) todas.push_back(c);
+            t.cpusPorNodo.push_back(todas);
+            t.idNodo.assign(1, 0);
+        }
+#endif
+        if (t.cpusPorNodo.empty() || t.cpusPorNodo[0].empty()) {
+            t.cpusPorNodo.assign(1, {});
+            t.idNodo.assign(1, 0);
+            for (int c = 0; c < omp_get_num_procs(); c++) t.cpusPorNodo[0].push_back(c);
+        }
+        for (int n = 0; n < t.numNodos(); n++) {
+            for (int c : t.cpusPorNodo[n]) {
+                if (c >= (int)t.nodoDeCpu.size()) t.nodoDeCpu.resize(c + 1, -1);
+                t.nodoDeCpu[c] = t.idNodo[n];
+            }
+        }
+        return t;
+    }
+
+    // CPU en el orden en que se asignan a los hilos 0, 1, 2...
+    std::vector<int> ordenCpus(Afinidad a) const {
+        std::vector<int> orden;
+        if (a == Afinidad::Dispersa) {
+            for (size_t i = 0;; i++) {
+                bool alguna = false;
+                for (const auto& cpus : cpusPorNodo) {
+                    if (i < cpus.size()) { orden.push_back(cpus[i]); alguna = true; }
+                }
+                if (!alguna) break;
+            }
+        } else {
+            for (const auto& cpus : cpusPorNodo) orden.insert(orden.end(), cpus.begin(), cpus.end());
+        }
+        return orden;
+    }
+};
+
+// La topología no cambia durante la corrida: se lee una sola vez
+inline const TopologiaNuma& topologiaNuma() {
+    static const TopologiaNuma t = TopologiaNuma::detectar();
+    return t;
+}
+
+// El runtime ya fija los hilos (OMP_PROC_BIND / OMP_PLACES del entorno)
+inline bool afinidadDelRuntime() {
+    return omp_get_proc_bind() != omp_proc_bind_false;
+}
+
+// Fija el hilo que llama a la CPU que le toca según la política. Devuelve
+// false si no se fijó (sin política, el runtime ya lo hace o falló la llamada).
+inline bool fijarHilo(int hilo, Afinidad a) {
+    if (a == Afinidad::Ninguna || afinidadDelRuntime()) return false;
+#ifdef AFINIDAD_LINUX
+    static const std::vector<int> compacta = topologiaNuma().ordenCpus(Afinidad::Compacta);
+    static const std::vector<int> dispersa = topologiaNuma().ordenCpus(Afinidad::Dispersa);
+    const std::vector<int>& orden = (a == Afinidad::Dispersa) ? dispersa : compacta;
+    if (orden.empty()) return false;
+    cpu_set_t cpus;
+    CPU_ZERO(&cpus);
+    CPU_SET(orden[hilo % orden.size()], &cpus);
+    return sched_setaffinity(0, sizeof(cpus), &cpus) == 0;
+#else
+    (void)hilo;
+    return false;
+#endif
+}
+
+// CPU y nodo donde corre ahora el hilo que llama (-1 si no se sabe)
+inline void ubicacionActual(int& cpu, int& nodo) {
+    cpu = nodo = -1;
+#ifdef AFINIDAD_LINUX
+    unsigned c = 0, n = 0;
+    if (syscall(SYS_getcpu, &c, &n, nullptr) == 0) {
+        cpu = (int)c;
+        nodo = (int)n;
+    }
+#endif
+}
+
+// Suma por nodo de lo que hicieron los hilos
+struct ResumenNodo {
+    int nodo = 0;
+    int hilos = 0;
+    long long tareas = 0;
+    double ocupado = 0;
+    double ocioso = 0;
+};
+
+template <class EstadisticasPorHilo>
+std::vector<ResumenNodo> resumirPorNodo(const EstadisticasPorHilo& porHilo) {
+    std::vector<ResumenNodo> nodos;
+    for (const auto& h : porHilo) {
+        int n = h.nodo < 0 ? 0 : h.nodo;
+        if (n >= (int)nodos.size()) {
+            int anterior = (int)nodos.size();
+            nodos.resize(n + 1);
+            for (int i = anterior; i <= n; i++) nodos[i].nodo = i;
+        }
+        nodos[n].hilos++;
+        nodos[n].tareas += h.tareas;
+        nodos[n].ocupado += h.ocupado;
+        nodos[n].ocioso += h.ocioso;
+    }
+    // Los nodos sin hilos no aportan nada al reporte
+    std::vector<ResumenNodo> usados;
+    for (const auto& r : nodos) if (r.hilos > 0) usados.push_back(r);
+    return usados;
+}
@@ -0,0 +1,180 @@
+#pragma once
+
+#include "simulador_supermercado.hpp"
+#include "planificador.hpp"
+
+// Simulación de una cadena: varias tiendas durante varios días. Cada
+// tienda-día es una partición independiente con su propio simulador (y por
+// lo tanto su propio inventario), que corre entera en un solo hilo: nunca se
+// reparten los clientes de una tienda-día entre hilos, así no hay stock
+// compartido ni contención. Las particiones se reparten con robo de trabajo
+// porque su tamaño varía (tiendas grandes y chicas, fines de semana).
+//
+// Cada partición guarda su resultado en su casilla y al final se fusionan
+// en orden de partición, así el total no depende de qué hilo corrió qué.
+
+constexpr uint32_t DOMINIO_CADENA = 3;
+
+struct ConfigCadena {
+    int tiendas = 1;
+    int dias = 1;
+    int clientesPorDia = 3500;   // para una tienda de tamaño medio en día de semana
+    int hilos = 0;
+    uint64_t semilla = 0;
+    vector<ProductoArchivo> catalogo;   // vacío = catálogo incorporado
+    string catalogoColumnar;            // si no está vacío, se mapea en cada tienda-día
+    vector<PerfilArchivo> perfiles;     // vacío = perfiles incorporados
+};
+
+struct ResultadoTiendaDia {
+    int tienda = 0;
+    int dia = 0;
+    int clientes = 0;
+    uint64_t semilla = 0;
+    double segundos = 0;
+    int hilo = -1;
+    AcumuladorEstadisticas est;
+    vector<int> vendidos;        // por producto
+};
+
+struct ResultadoCadena {
+    vector<ResultadoTiendaDia> particiones;   // índice = tienda * dias + dia
+    AcumuladorEstadisticas total;
+    vector<long long> vendidos;               // por producto, toda la cadena
+    vector<string> nombres;
+    vector<EstadisticasHilo> hilos;
+    double segundos = 0;
+};
+
+class SimuladorCadena {
+public:
+    explicit SimuladorCadena(const ConfigCadena& cfg) : cfg(cfg) {
+        if (cfg.tiendas < 1 || cfg.dias < 1)
+            throw invalid_argument("la cadena necesita al menos una tienda y un día");
+        // Las particiones se numeran con int (tienda * dias + dia)
+        long long particiones = (long long)cfg.tiendas * cfg.dias;
+        if (particiones > numeric_limits<int>::max())
+            throw invalid_argument("demasiadas tiendas-día: " + to_string(particiones) +
+                                   " (máximo " + to_string(numeric_limits<int>::max()) + ")");
+    }
+
+    // Semilla propia de la tienda-día, derivada de la semilla de la cadena
+    uint64_t semillaParticion(int tienda, int dia) const {
+        philox::Bloque b = philox::generar((uint32_t)tienda, (uint32_t)dia, DOMINIO_CADENA, 0,
+                                           (uint32_t)cfg.semilla, (uint32_t)(cfg.semilla >> 32));
+        return ((uint64_t)b.v[1] << 32) | b.v[0];
+    }
+
+    // Clientes de la tienda-día: tamaño de la tienda entre 0.5x y 1.5x (fijo
+    // para cada tienda) y 30% más los sábados y domingos
+    int clientesParticion(int tienda, int dia) const {
+        philox::Bloque b = philox::generar((uint32_t)tienda, 0xFFFFFFFFu, DOMINIO_CADENA, 0,
+                                           (uint32_t)cfg.semilla, (uint32_t)(cfg.semilla >> 32));
+        double tamano = philox::realEnRango(b.v[0], 0.5, 1.5);
+        double finDeSemana = (dia % 7 >= 5) ? 1.3 : 1.0;
+        return max(1, (int)llround(cfg.clientesPorDia * tamano * finDeSemana));
+    }
+
+    ResultadoCadena ejecutar() {
+        auto inicio = high_resolution_clock::now();
+        ResultadoCadena r;
+        int numParticiones = cfg.tiendas * cfg.dias;
+        r.particiones.resize(numParticiones);
+
+        r.hilos = ejecutarConRobo(numParticiones, cfg.hilos, [&](int p, int hilo) {
+            auto t0 = high_resolution_clock::now();
+            ResultadoTiendaDia& rp = r.particiones[p];
+            rp.tienda = p / cfg.dias;
+            rp.dia = p % cfg.dias;
+            rp.clientes = clientesParticion(rp.tienda, rp.dia);
+            rp.semilla = semillaParticion(rp.tienda, rp.dia);
+            rp.hilo = hilo;
+
+            SimuladorSupermercado sim(rp.semilla);
+            sim.setVerboso(false);
+            sim.setModoStreaming(true);
+            if (!cfg.catalogoColumnar.empty()) sim.cargarCatalogoColumnar(cfg.catalogoColumnar);
+            else if (!cfg.catalogo.empty()) sim.cargarCatalogo(cfg.catalogo);
+            if (!cfg.perfiles.empty()) sim.setPerfiles(cfg.perfiles);
+            sim.ejecutarSimulacion(rp.clientes);
+            rp.est = sim.getAcumulado();
+            rp.vendidos = sim.getInventario().vendidos;
+            if (p == 0) {
+                const PoolTextos& nombres = sim.getInventario().nombre;
+                for (size_t i = 0; i < nombres.size(); i++) r.nombres.emplace_back(nombres[i]);
+            }
+            rp.segundos = duration<double>(high_resolution_clock::now() - t0).count();
+        });
+
+        for (const auto& rp : r.particiones) {
+            r.total.fusionar(rp.est);
+            if (r.vendidos.size() < rp.vendidos.size()) r.vendidos.resize(rp.vendidos.size(), 0);
+            for (size_t i = 0; i < rp.vendidos.size(); i++) r.vendidos[i] += rp.vendidos[i];
+        }
+        r.segundos = duration<double>(high_resolution_clock::now() - inicio).count();
+        return r;
+    }
+
+    void mostrar(const ResultadoCadena& r) const {
+        const AcumuladorEstadisticas& t = r.total;
+        cout << "\n========================================" << endl;
+        cout << "     CADENA: " << cfg.tiendas << " tiendas x " << cfg.dias << " días" << endl;
+        cout << "========================================" << endl;
+        cout << "Tiendas-día: " << r.particiones.size() << " | Clientes: " << t.clientes
+             << " | Tiempo: " << fixed << setprecision(3) << r.segundos << " s" << endl;
+        cout << "Ventas totales: $" << setprecision(2) << t.ventasTotales()
+             << " | Productos vendidos: " << t.productosVendidos << endl;
+        if (t.clientes > 0) {
+            cout << "Promedio por cliente: $" << t.ventasTotales() / t.clientes
+                 << " | Tarjeta: " << setprecision(1) << t.pagosTarjeta * 100.0 / t.clientes << "%" << endl;
+        }
+
+        cout << "\n--- VENTAS POR TIENDA ---" << endl;
+        for (int s = 0; s < cfg.tiendas; s++) {
+            AcumuladorEstadisticas tienda;
+            for (int d = 0; d < cfg.dias; d++) tienda.fusionar(r.particiones[s * cfg.dias + d].est);
+            cout << "Tienda " << right << setw(3) << (s + 1) << ": " << setw(9) << tienda.clientes
+                 << " clientes | $" << fixed << setprecision(2) << tienda.ventasTotales() << endl;
+        }
+
+        cout << "\n--- TOP 5 PRODUCTOS DE LA CADENA ---" << endl;
+        TopProductos top(5);
+        for (size_t p = 0; p < r.vendidos.size(); p++)
+            if (r.vendidos[p] > 0) top.agregar((int)p, (int)min<long long>(r.vendidos[p], INT32_MAX));
+        int i = 1;
+        for (const auto& e : top.ordenados())
+            cout << right << setw(2) << i++ << ". " << left << setw(25) << r.nombres[e.producto]
+                 << " - " << r.vendidos[e.producto] << " unidades" << endl;
+
+        cout << "\n--- REPARTO ENTRE HILOS (robo de trabajo) ---" << endl;
+        for (size_t h = 0; h < r.hilos.size(); h++) {
+            const EstadisticasHilo& eh = r.hilos[h];
+            cout << "Hilo " << right << setw(2) << h << ": " << setw(5) << eh.tareas << " tiendas-día, "
+                 << setw(4) << eh.robos << " robadas | ocupado " << setprecision(3) << eh.ocupado
+                 << " s | ocioso " << eh.ocioso << " s" << endl;
+        }
+    }
+
+    void exportar(const ResultadoCadena& r, Resultados& res) const {
+        const AcumuladorEstadisticas& t = r.total;
+        res.agregar("tiendas", cfg.tiendas);
+        res.agregar("dias", cfg.dias);
+        res.agregar("semilla", (unsigned long long)cfg.semilla);
+        res.agregar("hilos", (int)r.hilos.size());
+        res.agregar("tiempo_s", r.segundos, 9);
+        res.agregar("clientes_simulados", t.clientes);
+        res.agregar("ventas_totales", t.ventasTotales(), 2);
+        res.agregar("productos_vendidos", t.productosVendidos);
+        res.agregar("pagos_tarjeta", t.pagosTarjeta);
+        res.agregar("pagos_efectivo", t.pagosEfectivo);
+        res.agregar("tiempo_compra_medio_s", t.tiempoMedio, 3);
+        long long robos = 0;
+        double ocioso = 0;
+        for (const auto& eh : r.hilos) { robos += eh.robos; ocioso += eh.ocioso; }
+        res.agregar("robos", robos);
+        res.agregar("ocioso_total_s", ocioso, 6);
+    }
+
+private:
+    ConfigCadena cfg;
+};
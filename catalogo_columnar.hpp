@@ -0,0 +1,528 @@
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "configuracion.hpp"
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define CATALOGO_MMAP 1
+#endif
+
+// Catálogo en un archivo binario por columnas, pensado para catálogos de
+// cientos de miles de productos. El archivo se mapea en memoria y las
+// columnas del catálogo apuntan directo a él: cargar no copia ni convierte
+// nada, solo valida. El mapeo es privado, así que el simulador puede
+// descontar stock sobre la columna mapeada sin tocar el archivo (las páginas
+// que se escriben se copian en ese momento).
+//
+// Formato (little-endian, cada sección empieza alineada a 64 bytes):
+//
+//   CabeceraCatalogo
+//   precio            double[n]
+//   precioCentavos    int32[n]
+//   stock             int32[n]      (-1 = lo sortea el simulador)
+//   categoria         uint16[n]     (índice en la tabla de categorías)
+//   nombre            uint64[n+1] desplazamientos + pool de caracteres
+//   categorías        uint64[c+1] desplazamientos + pool de caracteres
+//   peso              float[n]      (opcional: popularidad relativa)
+//   índices baratos / caros         int32, productos de cada clase de precio
+//   alias baratos / caros           uint32 probabilidad + int32 alias
+//                                   (opcionales, solo si hay pesos)
+//
+// Las tablas de alias permiten elegir un producto según su peso con un solo
+// sorteo, en tiempo constante. El convertidor (convertir_catalogo.cpp) las
+// calcula una vez y el simulador las usa tal cual.
+
+// Columna de un tipo simple: o es dueña de sus datos (catálogo armado en
+// memoria) o es una vista sobre memoria ajena que mantiene viva con 'dueno'
+// (un archivo mapeado). Agregar a una vista la copia primero.
+template <class T>
+class Columna {
+public:
+    Columna() = default;
+
+    static Columna vista(T* datos, size_t n, std::shared_ptr<void> dueno) {
+        Columna c;
+        c.p = datos;
+        c.n = n;
+        c.dueno = std::move(dueno);
+        return c;
+    }
+
+    Columna(const Columna& o) : propios(o.propios), p(o.p), n(o.n), dueno(o.dueno) {
+        if (!dueno) sincronizar();
+    }
+    Columna(Columna&& o) noexcept
+        : propios(std::move(o.propios)), p(o.p), n(o.n), dueno(std::move(o.dueno)) {
+        if (!dueno) sincronizar();
+        o.p = nullptr;
+        o.n = 0;
+    }
+    Columna& operator=(Columna o) noexcept {
+        propios.swap(o.propios);
+        std::swap(p, o.p);
+        std::swap(n, o.n);
+        dueno.swap(o.dueno);
+        if (!dueno) sincronizar();
+        return *this;
+    }
+
+    size_t size() const { return n; }
+    bool empty() const { return n == 0; }
+    bool esVista() const { return (bool)dueno; }
+    T* data() { return p; }
+    const T* data() const { return p; }
+    T& operator[](size_t i) { return p[i]; }
+    const T& operator[](size_t i) const { return p[i]; }
+    T* begin() { return p; }
+    T* end() { return p + n; }
+    const T* begin() const { return p; }
+    const T* end() const { return p + n; }
+
+    void push_back(const T& v) {
+        hacerPropia();
+        propios.push_back(v);
+        sincronizar();
+    }
+
+    void agregar(const T* datos, size_t cuantos) {
+        hacerPropia();
+        propios.insert(propios.end(), datos, datos + cuantos);
+        sincronizar();
+    }
+
+    void clear() {
+        propios.clear();
+        dueno.reset();
+        sincronizar();
+    }
+
+private:
+    void hacerPropia() {
+        if (!dueno) return;
+        propios.assign(p, p + n);
+        dueno.reset();
+    }
+    void sincronizar() {
+        p = propios.data();
+        n = propios.size();
+    }
+
+    std::vector<T> propios;
+    T* p = nullptr;
+    size_t n = 0;
+    std::shared_ptr<void> dueno;
+};
+
+// Textos guardados uno tras otro en un solo bloque de caracteres
+class PoolTextos {
+public:
+    size_t size() const { return desplazamientos.empty() ? 0 : desplazamientos.size() - 1; }
+    bool empty() const { return size() == 0; }
+
+    std::string_view operator[](size_t i) const {
+        return std::string_view(datos.data() + desplazamientos[i],
+                                (size_t)(desplazamientos[i + 1] - desplazamientos[i]));
+    }
+
+    void push_back(const std::string& s) {
+        if (desplazamientos.empty()) desplazamientos.push_back(0);
+        datos.agregar(s.data(), s.size());
+        desplazamientos.push_back(datos.size());
+    }
+
+    void clear() {
+        desplazamientos.clear();
+        datos.clear();
+    }
+
+    Columna<uint64_t> desplazamientos;   // size() + 1 entradas
+    Columna<char> datos;
+};
+
+// Tabla de alias (Walker/Vose) para elegir la posición i con probabilidad
+// proporcional a su peso. Con un sorteo x: la parte alta de x*n elige la
+// columna y la baja decide entre la columna y su alias.
+struct TablaAlias {
+    Columna<uint32_t> prob;   // umbral sobre 2^32 para quedarse con la columna
+    Columna<int32_t> alias;
+
+    bool empty() const { return prob.empty(); }
+    size_t size() const { return prob.size(); }
+
+    int elegir(uint32_t x) const {
+        uint64_t m = (uint64_t)x * (uint32_t)prob.size();
+        uint32_t i = (uint32_t)(m >> 32);
+        uint32_t moneda = (uint32_t)m;
+        return moneda < prob[i] ? (int)i : alias[i];
+    }
+};
+
+inline TablaAlias construirTablaAlias(const std::vector<double>& pesos) {
+    TablaAlias t;
+    size_t n = pesos.size();
+    double total = 0;
+    for (double w : pesos) total += w;
+    std::vector<double> escalado(n);
+    std::vector<uint32_t> prob(n, UINT32_MAX);
+    std::vector<int32_t> alias(n);
+    std::vector<int32_t> chicos, grandes;
+    for (size_t i = 0; i < n; i++) {
+        alias[i] = (int32_t)i;
+        // Sin peso total no hay preferencia: todos iguales
+        escalado[i] = total > 0 ? pesos[i] * n / total : 1.0;
+        (escalado[i] < 1.0 ? chicos : grandes).push_back((int32_t)i);
+    }
+    while (!chicos.empty() && !grandes.empty()) {
+        int32_t c = chicos.back(); chicos.pop_back();
+        int32_t g = grandes.back();
+        prob[c] = (uint32_t)(escalado[c] * 4294967296.0);
+        alias[c] = g;
+        escalado[g] -= 1.0 - escalado[c];
+        if (escalado[g] < 1.0) {
+            grandes.pop_back();
+            chicos.push_back(g);
+        }
+    }
+    // Lo que queda (por redondeo) se queda siempre con su propia columna
+    for (size_t i = 0; i < n; i++) {
+        t.prob.push_back(prob[i]);
+        t.alias.push_back(alias[i]);
+    }
+    return t;
+}
+
+// Archivo mapeado en memoria (privado y escribible). Sin mmap se lee entero.
+class ArchivoMapeado {
+public:
+    explicit ArchivoMapeado(const std::string& ruta) {
+#ifdef CATALOGO_MMAP
+        int fd = open(ruta.c_str(), O_RDONLY);
+        if (fd < 0) throw std::runtime_error("no se pudo abrir " + ruta);
+        struct stat st;
+        if (fstat(fd, &st) != 0) {
+            close(fd);
+            throw std::runtime_error("no se pudo leer el tamaño de " + ruta);
+        }
+        bytes = (size_t)st.st_size;
+        if (bytes > 0) {
+            void* m = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+            if (m == MAP_FAILED) {
+                close(fd);
+                throw std::runtime_error("no se pudo mapear " + ruta);
+            }
+            datos = static_cast<char*>(m);
+        }
+        close(fd);
+#else
+        std::ifstream f(ruta, std::ios::binary | std::ios::ate);
+        if (!f) throw std::runtime_error("no se pudo abrir " + ruta);
+        bytes = (size_t)f.tellg();
+        copia.reset(new uint64_t[(bytes + 7) / 8 + 1]);
+        datos = reinterpret_cast<char*>(copia.get());
+        f.seekg(0);
+        f.read(datos, (std::streamsize)bytes);
+#endif
+    }
+
+    ~ArchivoMapeado() {
+#ifdef CATALOGO_MMAP
+        if (datos) munmap(datos, bytes);
+#endif
+    }
+
+    ArchivoMapeado(const ArchivoMapeado&) = delete;
+    ArchivoMapeado& operator=(const ArchivoMapeado&) = delete;
+
+    char* datos = nullptr;
+    size_t bytes = 0;
+
+private:
+#ifndef CATALOGO_MMAP
+    std::unique_ptr<uint64_t[]> copia;   // alineada a 8 como el mapeo
+#endif
+};
+
+enum SeccionCatalogo {
+    SEC_PRECIO,
+    SEC_PRECIO_CENTAVOS,
+    SEC_STOCK,
+    SEC_CATEGORIA,
+    SEC_NOMBRE_DESPLAZAMIENTOS,
+    SEC_NOMBRE_TEXTO,
+    SEC_CATEGORIA_DESPLAZAMIENTOS,
+    SEC_CATEGORIA_TEXTO,
+    SEC_PESO,
+    SEC_INDICES_BARATOS,
+    SEC_INDICES_CAROS,
+    SEC_ALIAS_PROB_BARATOS,
+    SEC_ALIAS_BARATOS,
+    SEC_ALIAS_PROB_CAROS,
+    SEC_ALIAS_CAROS,
+    NUM_SECCIONES
+};
+
+constexpr char MAGIA_CATALOGO[8] = {'S', 'U', 'P', 'C', 'A', 'T', '0', '1'};
+constexpr uint32_t VERSION_CATALOGO = 1;
+constexpr uint32_t CATALOGO_STOCK_SORTEADO = 1;   // algún producto trae stock -1
+constexpr uint32_t CATALOGO_CON_PESOS = 2;
+
+struct SeccionArchivo {
+    uint64_t desplazamiento;
+    uint64_t bytes;
+};
+
+struct CabeceraCatalogo {
+    char magia[8];
+    uint32_t version;
+    uint32_t banderas;
+    uint64_t numProductos;
+    uint64_t numCategorias;
+    uint64_t numBaratos;
+    uint64_t numCaros;
+    double precioCaro;        // umbral con el que se armaron las clases
+    SeccionArchivo secciones[NUM_SECCIONES];
+};
+
+// Columnas de un catálogo columnar ya validado
+struct MapaCatalogo {
+    Columna<double> precio;
+    Columna<int32_t> precioCentavos;
+    Columna<int32_t> stock;
+    Columna<uint16_t> categoria;
+    PoolTextos nombre;
+    std::vector<std::string> categorias;
+    Columna<float> peso;                 // vacía si el archivo no trae pesos
+    Columna<int32_t> indicesBaratos;
+    Columna<int32_t> indicesCaros;
+    TablaAlias aliasBaratos;
+    TablaAlias aliasCaros;
+    double precioCaro = 0;
+    bool stockSorteado = false;
+};
+
+inline bool esCatalogoColumnar(const std::string& ruta) {
+    std::ifstream f(ruta, std::ios::binary);
+    char magia[sizeof(MAGIA_CATALOGO)] = {};
+    return f.read(magia, sizeof(magia)) && std::memcmp(magia, MAGIA_CATALOGO, sizeof(magia)) == 0;
+}
+
+inline MapaCatalogo abrirCatalogoColumnar(const std::string& ruta) {
+    auto archivo = std::make_shared<ArchivoMapeado>(ruta);
+    auto error = [&](const std::string& que) {
+        return std::runtime_error(ruta + ": catálogo columnar inválido (" + que + ")");
+    };
+    if (archivo->bytes < sizeof(CabeceraCatalogo)) throw error("archivo demasiado corto");
+    CabeceraCatalogo cab;
+    std::memcpy(&cab, archivo->datos, sizeof(cab));
+    if (std::memcmp(cab.magia, MAGIA_CATALOGO, sizeof(MAGIA_CATALOGO)) != 0) throw error("firma");
+    if (cab.version != VERSION_CATALOGO) throw error("versión " + std::to_string(cab.version));
+    uint64_t n = cab.numProductos;
+    if (n == 0 || n > INT32_MAX) throw error("número de productos");
+    if (cab.numBaratos + cab.numCaros != n) throw error("clases de precio");
+
+    // Cada sección debe caber en el archivo, estar alineada y medir lo esperado
+    auto seccion = [&](int s, uint64_t tamElemento, uint64_t elementos, bool opcional = false) -> char* {
+        const SeccionArchivo& sec = cab.secciones[s];
+        if (opcional && sec.bytes == 0) return nullptr;
+        if (sec.desplazamiento % 8 != 0 || sec.desplazamiento > archivo->bytes
+            || sec.bytes > archivo->bytes - sec.desplazamiento)
+            throw error("sección " + std::to_string(s) + " fuera del archivo");
+        if (elementos != UINT64_MAX && sec.bytes != tamElemento * elementos)
+            throw error("tamaño de la sección " + std::to_string(s));
+        return archivo->datos + sec.desplazamiento;
+    };
+    auto vista = [&](auto* tipo, int s, uint64_t elementos) {
+        using T = std::remove_pointer_t<decltype(tipo)>;
+        return Columna<T>::vista(reinterpret_cast<T*>(seccion(s, sizeof(T), elementos)),
+                                 (size_t)elementos, archivo);
+    };
+
+    MapaCatalogo m;
+    m.precioCaro = cab.precioCaro;
+    m.stockSorteado = (cab.banderas & CATALOGO_STOCK_SORTEADO) != 0;
+    m.precio         = vista((double*)nullptr, SEC_PRECIO, n);
+    m.precioCentavos = vista((int32_t*)nullptr, SEC_PRECIO_CENTAVOS, n);
+    m.stock          = vista((int32_t*)nullptr, SEC_STOCK, n);
+    m.categoria      = vista((uint16_t*)nullptr, SEC_CATEGORIA, n);
+    m.indicesBaratos = vista((int32_t*)nullptr, SEC_INDICES_BARATOS, cab.numBaratos);
+    m.indicesCaros   = vista((int32_t*)nullptr, SEC_INDICES_CAROS, cab.numCaros);
+
+    m.nombre.desplazamientos = vista((uint64_t*)nullptr, SEC_NOMBRE_DESPLAZAMIENTOS, n + 1);
+    uint64_t bytesNombres = cab.secciones[SEC_NOMBRE_TEXTO].bytes;
+    m.nombre.datos = vista((char*)nullptr, SEC_NOMBRE_TEXTO, bytesNombres);
+
+    PoolTextos categorias;
+    categorias.desplazamientos = vista((uint64_t*)nullptr, SEC_CATEGORIA_DESPLAZAMIENTOS, cab.numCategorias + 1);
+    categorias.datos = vista((char*)nullptr, SEC_CATEGORIA_TEXTO, cab.secciones[SEC_CATEGORIA_TEXTO].bytes);
+
+    if (cab.banderas & CATALOGO_CON_PESOS) {
+        m.peso = vista((float*)nullptr, SEC_PESO, n);
+        m.aliasBaratos.prob  = vista((uint32_t*)nullptr, SEC_ALIAS_PROB_BARATOS, cab.numBaratos);
+        m.aliasBaratos.alias = vista((int32_t*)nullptr, SEC_ALIAS_BARATOS, cab.numBaratos);
+        m.aliasCaros.prob    = vista((uint32_t*)nullptr, SEC_ALIAS_PROB_CAROS, cab.numCaros);
+        m.aliasCaros.alias   = vista((int32_t*)nullptr, SEC_ALIAS_CAROS, cab.numCaros);
+    }
+
+    // Una pasada lineal sobre los índices: un archivo dañado no debe poder
+    // hacer que el simulador lea fuera de las columnas
+    auto textosValidos = [](const PoolTextos& t) {
+        uint64_t anterior = 0;
+        for (uint64_t d : t.desplazamientos) {
+            if (d < anterior || d > t.datos.size()) return false;
+            anterior = d;
+        }
+        return true;
+    };
+    if (!textosValidos(m.nombre)) throw error("desplazamientos de nombres");
+    if (!textosValidos(categorias)) throw error("desplazamientos de categorías");
+    for (uint16_t c : m.categoria)
+        if (c >= cab.numCategorias) throw error("categoría fuera de rango");
+    for (int32_t i : m.indicesBaratos)
+        if (i < 0 || (uint64_t)i >= n) throw error("índice de producto");
+    for (int32_t i : m.indicesCaros)
+        if (i < 0 || (uint64_t)i >= n) throw error("índice de producto");
+    for (const TablaAlias* t : {&m.aliasBaratos, &m.aliasCaros})
+        for (int32_t a : t->alias)
+            if (a < 0 || (size_t)a >= t->size()) throw error("tabla de alias");
+
+    for (size_t c = 0; c < categorias.size(); c++) m.categorias.emplace_back(categorias[c]);
+    return m;
+}
+
+// Escribe un catálogo columnar. Las categorías se numeran por orden de
+// aparición y las clases de precio se arman como en el simulador, así que
+// cargar el archivo da el mismo catálogo que cargar la lista directamente.
+inline void escribirCatalogoColumnar(const std::vector<ProductoArchivo>& productos,
+                                     double precioCaro, const std::string& ruta) {
+    if (productos.empty()) throw std::invalid_argument("catálogo vacío");
+    size_t n = productos.size();
+    std::vector<double> precio;
+    std::vector<int32_t> centavos, stock, baratos, caros;
+    std::vector<uint16_t> categoria;
+    std::vector<float> peso;
+    std::vector<double> pesoBaratos, pesoCaros;
+    std::vector<std::string> categorias;
+    std::unordered_map<std::string, uint16_t> idsCategoria;
+    std::vector<uint64_t> despNombres{0}, despCategorias{0};
+    std::string nombres, textoCategorias;
+    bool conPesos = false, stockSorteado = false;
+    for (const auto& p : productos) conPesos = conPesos || p.peso >= 0;
+
+    for (size_t i = 0; i < n; i++) {
+        const ProductoArchivo& p = productos[i];
+        precio.push_back(p.precio);
+        centavos.push_back((int32_t)std::llround(p.precio * 100));
+        stock.push_back(p.stock >= 0 ? p.stock : -1);
+        stockSorteado = stockSorteado || p.stock < 0;
+        auto it = idsCategoria.find(p.categoria);
+        if (it == idsCategoria.end()) {
+            if (categorias.size() >= 65535) throw std::length_error("demasiadas categorías");
+            it = idsCategoria.emplace(p.categoria, (uint16_t)categorias.size()).first;
+            categorias.push_back(p.categoria);
+            textoCategorias += p.categoria;
+            despCategorias.push_back(textoCategorias.size());
+        }
+        categoria.push_back(it->second);
+        nombres += p.nombre;
+        despNombres.push_back(nombres.size());
+        double w = p.peso >= 0 ? p.peso : 1.0;
+        peso.push_back((float)w);
+        bool caro = p.precio > precioCaro;
+        (caro ? caros : baratos).push_back((int32_t)i);
+        (caro ? pesoCaros : pesoBaratos).push_back(w);
+    }
+
+    TablaAlias aliasBaratos, aliasCaros;
+    if (conPesos) {
+        aliasBaratos = construirTablaAlias(pesoBaratos);
+        aliasCaros = construirTablaAlias(pesoCaros);
+    }
+
+    CabeceraCatalogo cab;
+    std::memset(&cab, 0, sizeof(cab));
+    std::memcpy(cab.magia, MAGIA_CATALOGO, sizeof(MAGIA_CATALOGO));
+    cab.version = VERSION_CATALOGO;
+    cab.banderas = (stockSorteado ? CATALOGO_STOCK_SORTEADO : 0) | (conPesos ? CATALOGO_CON_PESOS : 0);
+    cab.numProductos = n;
+    cab.numCategorias = categorias.size();
+    cab.numBaratos = baratos.size();
+    cab.numCaros = caros.size();
+    cab.precioCaro = precioCaro;
+
+    std::vector<std::pair<const void*, uint64_t>> datos(NUM_SECCIONES, {nullptr, 0});
+    auto poner = [&](int s, const void* p, uint64_t bytes) { datos[s] = {p, bytes}; };
+    poner(SEC_PRECIO, precio.data(), n * sizeof(double));
+    poner(SEC_PRECIO_CENTAVOS, centavos.data(), n * sizeof(int32_t));
+    poner(SEC_STOCK, stock.data(), n * sizeof(int32_t));
+    poner(SEC_CATEGORIA, categoria.data(), n * sizeof(uint16_t));
+    poner(SEC_NOMBRE_DESPLAZAMIENTOS, despNombres.data(), despNombres.size() * sizeof(uint64_t));
+    poner(SEC_NOMBRE_TEXTO, nombres.data(), nombres.size());
+    poner(SEC_CATEGORIA_DESPLAZAMIENTOS, despCategorias.data(), despCategorias.size() * sizeof(uint64_t));
+    poner(SEC_CATEGORIA_TEXTO, textoCategorias.data(), textoCategorias.size());
+    poner(SEC_INDICES_BARATOS, baratos.data(), baratos.size() * sizeof(int32_t));
+    poner(SEC_INDICES_CAROS, caros.data(), caros.size() * sizeof(int32_t));
+    if (conPesos) {
+        poner(SEC_PESO, peso.data(), n * sizeof(float));
+        poner(SEC_ALIAS_PROB_BARATOS, aliasBaratos.prob.data(), aliasBaratos.size() * sizeof(uint32_t));
+        poner(SEC_ALIAS_BARATOS, aliasBaratos.alias.data(), aliasBaratos.size() * sizeof(int32_t));
+        poner(SEC_ALIAS_PROB_CAROS, aliasCaros.prob.data(), aliasCaros.size() * sizeof(uint32_t));
+        poner(SEC_ALIAS_CAROS, aliasCaros.alias.data(), aliasCaros.size() * sizeof(int32_t));
+    }
+
+    auto alinear = [](uint64_t x) { return (x + 63) & ~(uint64_t)63; };
+    uint64_t pos = alinear(sizeof(CabeceraCatalogo));
+    for (int s = 0; s < NUM_SECCIONES; s++) {
+        cab.secciones[s] = {pos, datos[s].second};
+        pos = alinear(pos + datos[s].second);
+    }
+
+    std::ofstream f(ruta, std::ios::binary | std::ios::trunc);
+    if (!f) throw std::runtime_error("no se pudo crear " + ruta);
+    static const char ceros[64] = {};
+    uint64_t escrito = 0;
+    auto escribir = [&](const void* p, uint64_t bytes) {
+        f.write(static_cast<const char*>(p), (std::streamsize)bytes);
+        escrito += bytes;
+    };
+    escribir(&cab, sizeof(cab));
+    for (int s = 0; s < NUM_SECCIONES; s++) {
+        escribir(ceros, cab.secciones[s].desplazamiento - escrito);
+        if (datos[s].second > 0) escribir(datos[s].first, datos[s].second);
+    }
+    if (!f) throw std::runtime_error("error al escribir " + ruta);
+}
+
+// El catálogo columnar como lista de productos, para el motor secuencial
+// original que arma su propio catálogo
+inline std::vector<ProductoArchivo> leerCatalogoColumnarComoLista(const std::string& ruta) {
+    MapaCatalogo m = abrirCatalogoColumnar(ruta);
+    std::vector<ProductoArchivo> productos(m.precio.size());
+    for (size_t i = 0; i < productos.size(); i++) {
+        productos[i].nombre = std::string(m.nombre[i]);
+        productos[i].precio = m.precio[i];
+        productos[i].categoria = m.categorias[m.categoria[i]];
+        productos[i].stock = m.stock[i];
+        if (!m.peso.empty()) productos[i].peso = m.peso[i];
+    }
+    return productos;
+}
+
+// Cualquiera de los dos formatos de catálogo, como lista
+inline std::vector<ProductoArchivo> leerCatalogo(const std::string& ruta) {
+    return esCatalogoColumnar(ruta) ? leerCatalogoColumnarComoLista(ruta) : leerCatalogoCsv(ruta);
+}
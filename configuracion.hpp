@@ -0,0 +1,478 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <ostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Configuración de una corrida sin preguntar nada por consola, para lanzar
+// muchas corridas desde scripts. Cada opción se puede dar como argumento
+// (--clave valor o --clave=valor) o en un archivo de configuración con
+// líneas "clave = valor" (los '#' inician comentarios). Los argumentos se
+// aplican en orden, así que lo que venga después de --config lo sobrescribe.
+//
+//   clientes  número de clientes a simular
+//   modo      secuencial | mutex | atomico | fragmentado (o 1-4)
+//   hilos     hilos de OpenMP (0 = máximo del sistema)
+//   semilla   semilla fija (por defecto, aleatoria)
+//   catalogo  archivo CSV "nombre,precio,categoria[,stock[,peso]]" o
+//             catálogo columnar binario (ver catalogo_columnar.hpp)
+//   formato   texto | json | csv
+//   salida    archivo donde escribir los resultados (por defecto, stdout)
+//   contadores si | no: contadores de hardware por fase (perf_event_open)
+//   cajas     número de cajas para la simulación de colas (0 = no simular)
+//   llegadas  clientes por hora que entran a la tienda (0 = 85% de uso de cajas)
+//   tiendas, dias  simular una cadena (clientes = por tienda y día)
+//   planificacion  estatica | dinamica | guiada | robo: reparto de los lotes
+//                  de clientes entre hilos en los modos paralelos
+//   afinidad  no | compacta | dispersa: fijar hilos a CPU por nodo NUMA
+//   transacciones  archivo donde guardar cada cliente y sus líneas (registro
+//                  binario por columnas, ver registro_transacciones.hpp)
+//   perfiles  CSV "nombre,peso,min,max,probCaro" con los tipos de comprador
+//             (por defecto los 4 incorporados, ver lote_clientes.hpp)
+//   instantanea  archivo donde guardar el estado de la corrida (streaming),
+//                cada 'cada' clientes, para seguirla con reanudar = si
+//                (ver instantanea.hpp)
+//   traza     archivo JSON (Chrome/Perfetto) con la línea de tiempo por hilo
+//             de clientes, lotes, esperas de lock y fases; 'eventos' fija
+//             cuántos eventos guarda cada hilo (ver traza.hpp)
+//   locks     si | no: contención de los locks por producto en modo mutex;
+//             'muestreo' N mide una de cada N tomas (ver contencion_locks.hpp)
+
+enum class FormatoSalida { Texto, Json, Csv };
+
+// Cómo se reparten los lotes de clientes entre los hilos
+enum class Planificacion { Estatica, Dinamica, Guiada, Robo };
+
+// Cómo se fijan los hilos a las CPU (ver afinidad_numa.hpp)
+enum class Afinidad {
+    Ninguna,    // el sistema operativo decide
+    Compacta,   // llena un nodo antes de pasar al siguiente
+    Dispersa    // reparte los hilos entre nodos por turnos
+};
+
+struct Configuracion {
+    int clientes = 3500;
+    int modo = 1;               // 1 secuencial, 2 mutex, 3 atómico, 4 fragmentado
+    int hilos = 0;
+    bool semillaFija = false;
+    uint64_t semilla = 0;
+    std::string catalogo;       // vacío = catálogo incorporado
+    FormatoSalida formato = FormatoSalida::Texto;
+    std::string salida;         // vacío = stdout
+    bool interactivo = true;    // sin argumentos se pregunta como siempre
+    bool contadores = false;
+    int cajas = 0;
+    double llegadasPorHora = 0;
+    int tiendas = 1;
+    int dias = 1;
+    Planificacion planificacion = Planificacion::Estatica;
+    Afinidad afinidad = Afinidad::Ninguna;
+    std::string transacciones;  // vacío = no se guarda el registro
+    std::string perfiles;       // vacío = perfiles incorporados
+    std::string instantanea;    // vacío = sin instantáneas para reanudar
+    long long cada = 1000000;   // clientes entre instantáneas
+    bool reanudar = false;
+    std::string traza;          // vacío = sin traza
+    long long eventosTraza = 1 << 18;   // por hilo; se guardan los últimos
+    bool locks = false;
+    int muestreo = 1;           // tomas de lock por cada una medida
+};
+
+inline std::string recortar(const std::string& s) {
+    size_t a = s.find_first_not_of(" \t\r\n");
+    if (a == std::string::npos) return "";
+    size_t b = s.find_last_not_of(" \t\r\n");
+    return s.substr(a, b - a + 1);
+}
+
+inline long long leerEntero(const std::string& clave, const std::string& valor,
+                            long long minimo, long long maximo) {
+    char* fin = nullptr;
+    long long v = std::strtoll(valor.c_str(), &fin, 10);
+    if (valor.empty() || *fin != '\0' || v < minimo || v > maximo)
+        throw std::invalid_argument("valor inválido para '" + clave + "': " + valor);
+    return v;
+}
+
+inline int leerModo(const std::string& valor) {
+    if (valor == "secuencial"  || valor == "1") return 1;
+    if (valor == "mutex"       || valor == "2") return 2;
+    if (valor == "atomico"     || valor == "3") return 3;
+    if (valor == "fragmentado" || valor == "4") return 4;
+    throw std::invalid_argument("modo desconocido: " + valor);
+}
+
+inline const char* nombreModo(int modo) {
+    switch (modo) {
+        case 2:  return "mutex";
+        case 3:  return "atomico";
+        case 4:  return "fragmentado";
+        default: return "secuencial";
+    }
+}
+
+inline Planificacion leerPlanificacion(const std::string& valor) {
+    if (valor == "estatica") return Planificacion::Estatica;
+    if (valor == "dinamica") return Planificacion::Dinamica;
+    if (valor == "guiada")   return Planificacion::Guiada;
+    if (valor == "robo")     return Planificacion::Robo;
+    throw std::invalid_argument("planificación desconocida: " + valor);
+}
+
+inline const char* nombrePlanificacion(Planificacion p) {
+    switch (p) {
+        case Planificacion::Dinamica: return "dinamica";
+        case Planificacion::Guiada:   return "guiada";
+        case Planificacion::Robo:     return "robo";
+        default:                      return "estatica";
+    }
+}
+
+inline Afinidad leerAfinidad(const std::string& valor) {
+    if (valor == "no" || valor == "ninguna") return Afinidad::Ninguna;
+    if (valor == "compacta") return Afinidad::Compacta;
+    if (valor == "dispersa") return Afinidad::Dispersa;
+    throw std::invalid_argument("afinidad desconocida: " + valor);
+}
+
+inline const char* nombreAfinidad(Afinidad a) {
+    switch (a) {
+        case Afinidad::Compacta: return "compacta";
+        case Afinidad::Dispersa: return "dispersa";
+        default:                 return "no";
+    }
+}
+
+// Archivos incluidos con 'config = ...' dentro de otro archivo de configuración
+constexpr int MAX_ANIDAMIENTO_CONFIG = 8;
+
+inline void leerArchivoConfiguracion(const std::string& ruta, Configuracion& cfg, int anidamiento = 0);
+
+inline void aplicarOpcion(Configuracion& cfg, const std::string& clave, const std::string& valor) {
+    if (clave == "clientes") {
+        cfg.clientes = (int)leerEntero(clave, valor, 1, 2147483647LL);
+    } else if (clave == "modo") {
+        cfg.modo = leerModo(valor);
+    } else if (clave == "hilos") {
+        cfg.hilos = (int)leerEntero(clave, valor, 0, 4096);
+    } else if (clave == "semilla") {
+        char* fin = nullptr;
+        cfg.semilla = std::strtoull(valor.c_str(), &fin, 0);
+        if (valor.empty() || *fin != '\0')
+            throw std::invalid_argument("semilla inválida: " + valor);
+        cfg.semillaFija = true;
+    } else if (clave == "catalogo") {
+        cfg.catalogo = valor;
+    } else if (clave == "formato") {
+        if      (valor == "texto") cfg.formato = FormatoSalida::Texto;
+        else if (valor == "json")  cfg.formato = FormatoSalida::Json;
+        else if (valor == "csv")   cfg.formato = FormatoSalida::Csv;
+        else throw std::invalid_argument("formato desconocido: " + valor);
+    } else if (clave == "salida") {
+        cfg.salida = valor;
+    } else if (clave == "contadores") {
+        if      (valor == "si" || valor == "sí" || valor == "1") cfg.contadores = true;
+        else if (valor == "no" || valor == "0") cfg.contadores = false;
+        else throw std::invalid_argument("valor inválido para 'contadores': " + valor);
+    } else if (clave == "cajas") {
+        cfg.cajas = (int)leerEntero(clave, valor, 0, 100000);
+    } else if (clave == "llegadas") {
+        char* fin = nullptr;
+        cfg.llegadasPorHora = std::strtod(valor.c_str(), &fin);
+        if (valor.empty() || *fin != '\0' || cfg.llegadasPorHora < 0)
+            throw std::invalid_argument("valor inválido para 'llegadas': " + valor);
+    } else if (clave == "tiendas") {
+        cfg.tiendas = (int)leerEntero(clave, valor, 1, 1000000);
+    } else if (clave == "dias") {
+        cfg.dias = (int)leerEntero(clave, valor, 1, 100000);
+    } else if (clave == "planificacion") {
+        cfg.planificacion = leerPlanificacion(valor);
+    } else if (clave == "afinidad") {
+        cfg.afinidad = leerAfinidad(valor);
+    } else if (clave == "transacciones") {
+        cfg.transacciones = valor;
+    } else if (clave == "perfiles") {
+        cfg.perfiles = valor;
+    } else if (clave == "instantanea") {
+        cfg.instantanea = valor;
+    } else if (clave == "cada") {
+        cfg.cada = leerEntero(clave, valor, 1, 2147483647LL);
+    } else if (clave == "reanudar") {
+        if      (valor == "si" || valor == "sí" || valor == "1") cfg.reanudar = true;
+        else if (valor == "no" || valor == "0") cfg.reanudar = false;
+        else throw std::invalid_argument("valor inválido para 'reanudar': " + valor);
+    } else if (clave == "traza") {
+        cfg.traza = valor;
+    } else if (clave == "eventos") {
+        cfg.eventosTraza = leerEntero(clave, valor, 1, 1LL << 28);
+    } else if (clave == "locks") {
+        if      (valor == "si" || valor == "sí" || valor == "1") cfg.locks = true;
+        else if (valor == "no" || valor == "0") cfg.locks = false;
+        else throw std::invalid_argument("valor inválido para 'locks': " + valor);
+    } else if (clave == "muestreo") {
+        cfg.muestreo = (int)leerEntero(clave, valor, 1, 1000000);
+    } else if (clave == "config") {
+        leerArchivoConfiguracion(valor, cfg);
+    } else {
+        throw std::invalid_argument("opción desconocida: " + clave);
+    }
+}
+
+inline void leerArchivoConfiguracion(const std::string& ruta, Configuracion& cfg, int anidamiento) {
+    std::ifstream f(ruta);
+    if (!f) throw std::runtime_error("no se pudo abrir " + ruta);
+    std::string linea;
+    int numLinea = 0;
+    while (std::getline(f, linea)) {
+        numLinea++;
+        linea = recortar(linea.substr(0, linea.find('#')));
+        if (linea.empty()) continue;
+        size_t igual = linea.find('=');
+        if (igual == std::string::npos)
+            throw std::invalid_argument(ruta + ":" + std::to_string(numLinea) + ": falta '='");
+        std::string clave = recortar(linea.substr(0, igual));
+        std::string valor = recortar(linea.substr(igual + 1));
+        if (clave != "config") {
+            aplicarOpcion(cfg, clave, valor);
+        } else if (anidamiento + 1 >= MAX_ANIDAMIENTO_CONFIG) {
+            // También corta los archivos que se incluyen a sí mismos
+            throw std::invalid_argument(ruta + ":" + std::to_string(numLinea) + ": más de " +
+                                        std::to_string(MAX_ANIDAMIENTO_CONFIG) +
+                                        " archivos de configuración anidados");
+        } else {
+            leerArchivoConfiguracion(valor, cfg, anidamiento + 1);
+        }
+    }
+}
+
+// Devuelve false si se pidió la ayuda. Con al menos un argumento la corrida
+// deja de ser interactiva.
+inline bool leerArgumentos(int argc, char** argv, Configuracion& cfg) {
+    if (argc > 1) cfg.interactivo = false;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "-h" || arg == "--ayuda" || arg == "--help") return false;
+        if (arg.compare(0, 2, "--") != 0)
+            throw std::invalid_argument("argumento inesperado: " + arg);
+        std::string clave = arg.substr(2), valor;
+        size_t igual = clave.find('=');
+        if (igual != std::string::npos) {
+            valor = clave.substr(igual + 1);
+            clave = clave.substr(0, igual);
+        } else {
+            if (i + 1 >= argc) throw std::invalid_argument("falta el valor de --" + clave);
+            valor = argv[++i];
+        }
+        aplicarOpcion(cfg, clave, valor);
+    }
+    return true;
+}
+
+inline void mostrarAyuda(std::ostream& os, const char* programa, bool conModosParalelos) {
+    os << "Uso: " << programa << " [opciones]\n"
+       << "Sin opciones, el programa pregunta los datos por consola.\n\n"
+       << "  --clientes N        clientes a simular (por defecto 3500)\n";
+    if (conModosParalelos) {
+        os << "  --modo M            secuencial | mutex | atomico | fragmentado\n"
+           << "  --hilos H           hilos de OpenMP (0 = máximo del sistema)\n"
+           << "  --planificacion P   estatica | dinamica | guiada | robo (lotes por hilo)\n"
+           << "  --afinidad A        no | compacta | dispersa (hilos por nodo NUMA)\n"
+           << "  --transacciones ARCHIVO  guardar cada cliente y sus líneas (binario)\n"
+           << "  --instantanea ARCHIVO  guardar el estado cada --cada N clientes (streaming)\n"
+           << "  --reanudar si|no    seguir desde la instantánea si existe\n"
+           << "  --traza ARCHIVO     línea de tiempo por hilo en JSON de Chrome/Perfetto\n"
+           << "  --eventos N         eventos de traza por hilo (se guardan los últimos)\n"
+           << "  --locks si|no       contención de los locks por producto (modo mutex)\n"
+           << "  --muestreo N        medir una de cada N tomas de lock\n";
+    }
+    os << "  --semilla S         semilla fija para repetir una corrida\n"
+       << "  --catalogo ARCHIVO  CSV nombre,precio,categoria[,stock[,peso]] o catálogo columnar\n"
+       << "  --formato F         texto | json | csv\n"
+       << "  --salida ARCHIVO    escribir los resultados en ARCHIVO\n"
+       << "  --contadores si|no  contadores de hardware por fase y por hilo\n"
+       << "  --cajas N           simular colas en N cajas (0 = no)\n"
+       << "  --llegadas R        clientes por hora (0 = 85% de uso de las cajas)\n"
+       << "  --perfiles ARCHIVO  CSV nombre,peso,min,max,probCaro con los tipos de comprador\n"
+       << "  --tiendas T --dias D  simular una cadena; --clientes es por tienda y día\n"
+       << "  --config ARCHIVO    leer opciones 'clave = valor' desde ARCHIVO\n";
+}
+
+// Producto leído de un archivo de catálogo. stock < 0 significa que el
+// simulador elige el stock inicial como con el catálogo incorporado. peso < 0
+// es "sin peso": si ningún producto trae peso, todos son igual de populares.
+struct ProductoArchivo {
+    std::string nombre;
+    double precio;
+    std::string categoria;
+    int stock = -1;
+    double peso = -1;
+};
+
+// CSV simple, sin comillas: "nombre,precio,categoria[,stock[,peso]]". El
+// stock puede quedar vacío si se da el peso. Se ignoran líneas vacías,
+// comentarios '#' y una cabecera cuyo precio no sea número.
+inline std::vector<ProductoArchivo> leerCatalogoCsv(const std::string& ruta) {
+    std::ifstream f(ruta);
+    if (!f) throw std::runtime_error("no se pudo abrir el catálogo " + ruta);
+    std::vector<ProductoArchivo> productos;
+    std::string linea;
+    int numLinea = 0;
+    while (std::getline(f, linea)) {
+        numLinea++;
+        linea = recortar(linea);
+        if (linea.empty() || linea[0] == '#') continue;
+        std::vector<std::string> campos;
+        std::stringstream ss(linea);
+        std::string campo;
+        while (std::getline(ss, campo, ',')) campos.push_back(recortar(campo));
+        std::string donde = ruta + ":" + std::to_string(numLinea);
+        if (campos.size() < 3 || campos.size() > 5)
+            throw std::invalid_argument(donde + ": se esperan de 3 a 5 campos");
+        char* fin = nullptr;
+        double precio = std::strtod(campos[1].c_str(), &fin);
+        if (campos[1].empty() || *fin != '\0') {
+            if (productos.empty() && numLinea == 1) continue;   // cabecera
+            throw std::invalid_argument(donde + ": precio inválido");
+        }
+        if (precio < 0) throw std::invalid_argument(donde + ": precio negativo");
+        ProductoArchivo p{campos[0], precio, campos[2], -1, -1};
+        if (campos.size() >= 4 && !campos[3].empty())
+            p.stock = (int)leerEntero("stock", campos[3], 0, 1000000000LL);
+        if (campos.size() == 5) {
+            p.peso = std::strtod(campos[4].c_str(), &fin);
+            if (campos[4].empty() || *fin != '\0' || p.peso < 0)
+                throw std::invalid_argument(donde + ": peso inválido");
+        }
+        productos.push_back(p);
+    }
+    if (productos.empty()) throw std::invalid_argument(ruta + ": catálogo vacío");
+    return productos;
+}
+
+// Tipo de comprador leído de un archivo de perfiles. El peso es la
+// proporción de clientes de ese tipo (no hace falta que sumen 1); probCaro
+// es la probabilidad de elegir un producto caro en cada línea.
+struct PerfilArchivo {
+    std::string nombre;
+    double peso;
+    int minProductos;
+    int maxProductos;
+    double probCaro;
+};
+
+// CSV simple, sin comillas: "nombre,peso,min,max,probCaro", un perfil por
+// línea y como mucho 'maximo'. Mismas reglas que leerCatalogoCsv para
+// comentarios y cabecera.
+inline std::vector<PerfilArchivo> leerPerfilesCsv(const std::string& ruta, int maximo) {
+    std::ifstream f(ruta);
+    if (!f) throw std::runtime_error("no se pudo abrir el archivo de perfiles " + ruta);
+    std::vector<PerfilArchivo> perfiles;
+    std::string linea;
+    int numLinea = 0;
+    while (std::getline(f, linea)) {
+        numLinea++;
+        linea = recortar(linea);
+        if (linea.empty() || linea[0] == '#') continue;
+        std::vector<std::string> campos;
+        std::stringstream ss(linea);
+        std::string campo;
+        while (std::getline(ss, campo, ',')) campos.push_back(recortar(campo));
+        std::string donde = ruta + ":" + std::to_string(numLinea);
+        if (campos.size() != 5) throw std::invalid_argument(donde + ": se esperan 5 campos");
+        char* fin = nullptr;
+        double peso = std::strtod(campos[1].c_str(), &fin);
+        if (campos[1].empty() || *fin != '\0') {
+            if (perfiles.empty() && numLinea == 1) continue;   // cabecera
+            throw std::invalid_argument(donde + ": peso inválido");
+        }
+        if (!(peso > 0)) throw std::invalid_argument(donde + ": el peso debe ser positivo");
+        PerfilArchivo p{campos[0], peso, 0, 0, 0};
+        p.minProductos = (int)leerEntero("min", campos[2], 0, 10000);
+        p.maxProductos = (int)leerEntero("max", campos[3], p.minProductos, 10000);
+        p.probCaro = std::strtod(campos[4].c_str(), &fin);
+        if (campos[4].empty() || *fin != '\0' || p.probCaro < 0 || p.probCaro > 1)
+            throw std::invalid_argument(donde + ": probCaro debe estar entre 0 y 1");
+        perfiles.push_back(p);
+        if ((int)perfiles.size() > maximo)
+            throw std::invalid_argument(ruta + ": más de " + std::to_string(maximo) + " perfiles");
+    }
+    if (perfiles.empty()) throw std::invalid_argument(ruta + ": sin perfiles");
+    return perfiles;
+}
+
+// Resultados de una corrida como pares clave/valor en orden de inserción.
+// Se escriben como un objeto JSON, como CSV (cabecera + una fila) o como
+// texto "clave: valor".
+class Resultados {
+public:
+    void agregar(const std::string& clave, const std::string& valor) {
+        campos.push_back({clave, {valor, false}});
+    }
+    void agregar(const std::string& clave, const char* valor) {
+        agregar(clave, std::string(valor));
+    }
+    void agregar(const std::string& clave, long long valor) {
+        campos.push_back({clave, {std::to_string(valor), true}});
+    }
+    void agregar(const std::string& clave, unsigned long long valor) {
+        campos.push_back({clave, {std::to_string(valor), true}});
+    }
+    void agregar(const std::string& clave, int valor) { agregar(clave, (long long)valor); }
+    void agregar(const std::string& clave, double valor, int decimales = 6) {
+        std::ostringstream ss;
+        ss << std::fixed << std::setprecision(decimales) << valor;
+        campos.push_back({clave, {ss.str(), true}});
+    }
+
+    void escribir(std::ostream& os, FormatoSalida formato) const {
+        if (formato == FormatoSalida::Json) {
+            os << "{";
+            for (size_t i = 0; i < campos.size(); i++) {
+                os << (i ? ", " : "") << "\"" << campos[i].first << "\": ";
+                if (campos[i].second.second) os << campos[i].second.first;
+                else os << "\"" << escaparJson(campos[i].second.first) << "\"";
+            }
+            os << "}\n";
+        } else if (formato == FormatoSalida::Csv) {
+            for (size_t i = 0; i < campos.size(); i++) os << (i ? "," : "") << campos[i].first;
+            os << "\n";
+            for (size_t i = 0; i < campos.size(); i++) os << (i ? "," : "") << campos[i].second.first;
+            os << "\n";
+        } else {
+            for (const auto& c : campos) os << c.first << ": " << c.second.first << "\n";
+        }
+    }
+
+private:
+    // clave -> (valor ya formateado, es número)
+    std::vector<std::pair<std::string, std::pair<std::string, bool>>> campos;
+
+    static std::string escaparJson(const std::string& s) {
+        std::string o;
+        for (char c : s) {
+            if (c == '"' || c == '\\') { o += '\\'; o += c; }
+            else if (c == '\n') o += "\\n";
+            else if ((unsigned char)c < 0x20) o += ' ';
+            else o += c;
+        }
+        return o;
+    }
+};
+
+// Escribe los resultados en cfg.salida o, si no hay archivo, en 'porDefecto'
+inline void escribirResultados(const Resultados& r, const Configuracion& cfg, std::ostream& porDefecto) {
+    if (cfg.salida.empty()) {
+        r.escribir(porDefecto, cfg.formato);
+        return;
+    }
+    std::ofstream f(cfg.salida);
+    if (!f) throw std::runtime_error("no se pudo escribir " + cfg.salida);
+    r.escribir(f, cfg.formato);
+}
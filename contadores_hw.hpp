@@ -0,0 +1,190 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#define CONTADORES_HW_LINUX 1
+#endif
+
+// Contadores de hardware por hilo con perf_event_open (Linux). Cada evento se
+// abre por separado para el hilo que llama, solo en espacio de usuario, así
+// funciona con perf_event_paranoid <= 2. Si un evento no se puede abrir (sin
+// permisos, máquina virtual sin PMU, otro sistema operativo) queda marcado
+// como no disponible y el resto sigue midiendo. El tiempo de pared de cada
+// fase se mide siempre.
+
+enum EventoHw {
+    HW_CICLOS,
+    HW_INSTRUCCIONES,
+    HW_FALLOS_LLC,
+    HW_CAMBIOS_CONTEXTO,
+    NUM_EVENTOS_HW
+};
+
+inline const char* nombreEventoHw(int e) {
+    static const char* nombres[NUM_EVENTOS_HW] = {
+        "ciclos", "instrucciones", "fallos_llc", "cambios_contexto"
+    };
+    return nombres[e];
+}
+
+// Fases del simulador que se miden por separado
+enum FaseSimulacion {
+    FASE_INVENTARIO,    // catálogo y reparto de stock
+    FASE_GENERACION,    // cabeceras, carritos y reservas de stock
+    FASE_AGREGACION,    // acumuladores, fusión de parciales y reconciliación
+    FASE_REPORTE,       // top 10 y stock bajo
+    NUM_FASES
+};
+
+inline const char* nombreFase(int f) {
+    static const char* nombres[NUM_FASES] = {
+        "inventario", "generacion", "agregacion", "reporte"
+    };
+    return nombres[f];
+}
+
+struct LecturaHw {
+    uint64_t valor[NUM_EVENTOS_HW] = {};
+    bool disponible[NUM_EVENTOS_HW] = {};
+    uint64_t nanosegundos = 0;
+
+    LecturaHw& operator+=(const LecturaHw& o) {
+        nanosegundos += o.nanosegundos;
+        for (int e = 0; e < NUM_EVENTOS_HW; e++) {
+            valor[e] += o.valor[e];
+            disponible[e] = disponible[e] || o.disponible[e];
+        }
+        return *this;
+    }
+};
+
+// Contadores del hilo que construye el objeto. Empiezan a contar al
+// construirse; detener() devuelve lo acumulado desde entonces, escalado si
+// el kernel tuvo que multiplexar los contadores.
+class ContadoresHw {
+public:
+    ContadoresHw() {
+#ifdef CONTADORES_HW_LINUX
+        static const uint32_t tipos[NUM_EVENTOS_HW] = {
+            PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE, PERF_TYPE_SOFTWARE
+        };
+        static const uint64_t configs[NUM_EVENTOS_HW] = {
+            PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS,
+            PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_SW_CONTEXT_SWITCHES
+        };
+        for (int e = 0; e < NUM_EVENTOS_HW; e++) {
+            perf_event_attr attr;
+            memset(&attr, 0, sizeof(attr));
+            attr.size = sizeof(attr);
+            attr.type = tipos[e];
+            attr.config = configs[e];
+            attr.disabled = 1;
+            attr.exclude_kernel = 1;
+            attr.exclude_hv = 1;
+            attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+            fd[e] = (int)syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+        }
+        for (int e = 0; e < NUM_EVENTOS_HW; e++) {
+            if (fd[e] < 0) continue;
+            ioctl(fd[e], PERF_EVENT_IOC_RESET, 0);
+            ioctl(fd[e], PERF_EVENT_IOC_ENABLE, 0);
+        }
+#endif
+        inicio = std::chrono::steady_clock::now();
+    }
+
+    ~ContadoresHw() {
+#ifdef CONTADORES_HW_LINUX
+        for (int e = 0; e < NUM_EVENTOS_HW; e++)
+            if (fd[e] >= 0) close(fd[e]);
+#endif
+    }
+
+    ContadoresHw(const ContadoresHw&) = delete;
+    ContadoresHw& operator=(const ContadoresHw&) = delete;
+
+    LecturaHw detener() {
+        LecturaHw l;
+        l.nanosegundos = (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - inicio).count();
+#ifdef CONTADORES_HW_LINUX
+        for (int e = 0; e < NUM_EVENTOS_HW; e++) {
+            if (fd[e] < 0) continue;
+            ioctl(fd[e], PERF_EVENT_IOC_DISABLE, 0);
+            uint64_t datos[3];   // valor, tiempo habilitado, tiempo corriendo
+            if (read(fd[e], datos, sizeof(datos)) != (ssize_t)sizeof(datos)) continue;
+            l.valor[e] = (datos[2] > 0 && datos[2] < datos[1])
+                       ? (uint64_t)((double)datos[0] * datos[1] / datos[2]) : datos[0];
+            l.disponible[e] = true;
+        }
+#endif
+        return l;
+    }
+
+    // Qué eventos se pueden abrir en esta máquina (para avisar una sola vez)
+    static std::string diagnostico() {
+        ContadoresHw prueba;
+        LecturaHw l = prueba.detener();
+        std::string s;
+        for (int e = 0; e < NUM_EVENTOS_HW; e++) {
+            if (!s.empty()) s += ", ";
+            s += std::string(nombreEventoHw(e)) + (l.disponible[e] ? " sí" : " no");
+        }
+        return s;
+    }
+
+private:
+    int fd[NUM_EVENTOS_HW] = {-1, -1, -1, -1};
+    std::chrono::steady_clock::time_point inicio;
+};
+
+// Lecturas acumuladas por hilo y por fase. Cada hilo escribe solo su fila,
+// así no hace falta sincronizar mientras se mide.
+struct PerfilHw {
+    std::vector<std::vector<LecturaHw>> porHilo;   // [hilo][fase]
+
+    void preparar(int numHilos) {
+        if ((int)porHilo.size() < numHilos)
+            porHilo.resize(numHilos, std::vector<LecturaHw>(NUM_FASES));
+    }
+
+    void clear() { porHilo.clear(); }
+
+    LecturaHw totalFase(int fase) const {
+        LecturaHw t;
+        for (const auto& h : porHilo) t += h[fase];
+        return t;
+    }
+};
+
+// Mide una fase en el hilo actual mientras el objeto vive. Con perfil nulo
+// no hace nada, así el camino sin instrumentar no paga ni las llamadas.
+class MedicionFase {
+public:
+    MedicionFase(PerfilHw* perfil, int fase, int hilo)
+        : perfil(perfil), fase(fase), hilo(hilo),
+          contadores(perfil ? new ContadoresHw() : nullptr) {}
+
+    ~MedicionFase() {
+        if (contadores) perfil->porHilo[hilo][fase] += contadores->detener();
+    }
+
+    MedicionFase(const MedicionFase&) = delete;
+    MedicionFase& operator=(const MedicionFase&) = delete;
+
+private:
+    PerfilHw* perfil;
+    int fase;
+    int hilo;
+    std::unique_ptr<ContadoresHw> contadores;
+};
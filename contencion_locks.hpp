@@ -0,0 +1,122 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#include "linea_cache.hpp"
+#include "traza.hpp"
+
+// Contención de los locks por producto del modo mutex: cuántas veces se tomó
+// cada lock, cuántas de esas lo encontraron tomado y cuánto se esperó.
+//
+// Primero se intenta try_lock; si entra, la espera fue cero y no se lee el
+// reloj. Solo cuando falla se toma rdtsc antes y después de lock(). Los
+// contadores de un producto se actualizan con su lock ya tomado, así que no
+// necesitan atomics y cada uno va en su propia línea de caché.
+//
+// Con muestreo N cada hilo instrumenta una de cada N tomas y las demás van
+// directo a lock(); los totales se estiman multiplicando por N y los
+// percentiles salen de las esperas muestreadas.
+
+// Cubeta k: esperas de [2^k, 2^(k+1)) ticks (la 0 incluye el 0)
+constexpr int CUBETAS_ESPERA = 32;
+
+inline int cubetaEspera(uint64_t ticks) {
+    int k = 0;
+    while (ticks > 1 && k < CUBETAS_ESPERA - 1) {
+        ticks >>= 1;
+        k++;
+    }
+    return k;
+}
+
+struct alignas(TAM_LINEA_CACHE) ContencionProducto {
+    uint64_t adquisiciones = 0;     // tomas instrumentadas
+    uint64_t contendidas = 0;       // de ellas, con el lock ya tomado
+    uint64_t ticksEspera = 0;
+    uint32_t histograma[CUBETAS_ESPERA] = {};
+
+    void anotar(bool contendida, uint64_t ticks) {
+        adquisiciones++;
+        if (!contendida) return;
+        contendidas++;
+        ticksEspera += ticks;
+        histograma[cubetaEspera(ticks)]++;
+    }
+
+    void fusionar(const ContencionProducto& o) {
+        adquisiciones += o.adquisiciones;
+        contendidas += o.contendidas;
+        ticksEspera += o.ticksEspera;
+        for (int k = 0; k < CUBETAS_ESPERA; k++) histograma[k] += o.histograma[k];
+    }
+
+    // Percentil p (0-100) de la espera de las tomas contendidas, en ticks,
+    // interpolando linealmente dentro de la cubeta
+    double percentilTicks(double p) const {
+        if (contendidas == 0) return 0;
+        double objetivo = p / 100.0 * contendidas;
+        double acumulado = 0;
+        for (int k = 0; k < CUBETAS_ESPERA; k++) {
+            if (histograma[k] == 0) continue;
+            if (acumulado + histograma[k] >= objetivo) {
+                double desde = k == 0 ? 0.0 : (double)(1ULL << k);
+                double hasta = (double)(2ULL << k);
+                return desde + (hasta - desde) * (objetivo - acumulado) / histograma[k];
+            }
+            acumulado += histograma[k];
+        }
+        return (double)(2ULL << (CUBETAS_ESPERA - 1));
+    }
+};
+
+// Resultado de una corrida en modo mutex con los locks instrumentados
+struct PerfilLocks {
+    std::vector<ContencionProducto> productos;
+    int muestreo = 1;
+    double ticksPorNs = 1;
+    CalibracionTicks reloj;
+
+    void preparar(int numProductos) {
+        productos.assign(numProductos, ContencionProducto());
+        reloj.reiniciar();
+    }
+
+    // Al terminar la corrida: fija la conversión de ticks a nanosegundos
+    void cerrar() { ticksPorNs = reloj.ticksPorMicrosegundo() / 1000.0; }
+
+    ContencionProducto total() const {
+        ContencionProducto t;
+        for (const auto& c : productos) t.fusionar(c);
+        return t;
+    }
+
+    // Estimaciones para todas las tomas (las instrumentadas por el muestreo)
+    double adquisiciones(const ContencionProducto& c) const { return (double)c.adquisiciones * muestreo; }
+    double contendidas(const ContencionProducto& c) const { return (double)c.contendidas * muestreo; }
+    double esperaNs(const ContencionProducto& c) const { return c.ticksEspera * muestreo / ticksPorNs; }
+    double percentilNs(const ContencionProducto& c, double p) const { return c.percentilTicks(p) / ticksPorNs; }
+
+    // Los n productos con más espera (a igual espera, más contendidas)
+    std::vector<int> masContendidos(int n) const {
+        std::vector<int> ids;
+        for (int p = 0; p < (int)productos.size(); p++) {
+            if (productos[p].contendidas > 0) ids.push_back(p);
+        }
+        auto antes = [&](int a, int b) {
+            const ContencionProducto& x = productos[a];
+            const ContencionProducto& y = productos[b];
+            if (x.ticksEspera != y.ticksEspera) return x.ticksEspera > y.ticksEspera;
+            if (x.contendidas != y.contendidas) return x.contendidas > y.contendidas;
+            return a < b;
+        };
+        if ((int)ids.size() > n) {
+            std::partial_sort(ids.begin(), ids.begin() + n, ids.end(), antes);
+            ids.resize(n);
+        } else {
+            std::sort(ids.begin(), ids.end(), antes);
+        }
+        return ids;
+    }
+};
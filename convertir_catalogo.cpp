@@ -0,0 +1,77 @@
+#include "simulador_supermercado.hpp"
+
+// Convierte un catálogo CSV "nombre,precio,categoria[,stock[,peso]]" al
+// formato columnar que el simulador mapea sin copiar (catalogo_columnar.hpp).
+// Con --generar arma un catálogo sintético de N productos, para probar
+// catálogos grandes sin tener uno real a mano.
+//
+//   ./convertir_catalogo catalogo.csv catalogo.cat
+//   ./convertir_catalogo --generar 200000 catalogo.cat [--semilla S]
+
+// Catálogo sintético: precios log-uniformes entre 0.50 y 50.00, 40
+// categorías, stock entre 100 y 5000 y popularidad tipo Zipf (el producto
+// de rango r pesa 1/r^0.8), con los rangos mezclados entre productos.
+static vector<ProductoArchivo> generarCatalogo(int n, uint64_t semilla) {
+    const int CATEGORIAS = 40;
+    vector<ProductoArchivo> productos(n);
+    vector<int> rango(n);
+    for (int i = 0; i < n; i++) rango[i] = i;
+    philox::Flujo flujo(semilla, 0, 0);
+    for (int i = n - 1; i > 0; i--) swap(rango[i], rango[philox::enteroEnRango(flujo.siguiente(), 0, i)]);
+    for (int i = 0; i < n; i++) {
+        philox::Bloque b = philox::generar((uint32_t)i, 0, 0, 0, (uint32_t)semilla, (uint32_t)(semilla >> 32));
+        ProductoArchivo& p = productos[i];
+        p.nombre = "Producto " + to_string(i + 1);
+        p.precio = round(0.50 * pow(100.0, philox::uniforme01(b.v[0])) * 100) / 100;
+        p.categoria = "Categoria " + to_string(philox::enteroEnRango(b.v[1], 1, CATEGORIAS));
+        p.stock = philox::enteroEnRango(b.v[2], 100, 5000);
+        p.peso = 1.0 / pow(rango[i] + 1.0, 0.8);
+    }
+    return productos;
+}
+
+static void mostrarUso(ostream& os, const char* programa) {
+    os << "Uso: " << programa << " ENTRADA.csv SALIDA.cat\n"
+       << "     " << programa << " --generar N SALIDA.cat [--semilla S]\n";
+}
+
+int main(int argc, char** argv) {
+    vector<string> args(argv + 1, argv + argc);
+    try {
+        vector<ProductoArchivo> productos;
+        string salida;
+        auto inicio = steady_clock::now();
+        if (args.size() >= 3 && args[0] == "--generar") {
+            int n = (int)leerEntero("generar", args[1], 1, INT32_MAX);
+            salida = args[2];
+            uint64_t semilla = 1;
+            if (args.size() == 5 && args[3] == "--semilla") semilla = strtoull(args[4].c_str(), nullptr, 0);
+            else if (args.size() != 3) throw invalid_argument("argumentos de más");
+            productos = generarCatalogo(n, semilla);
+        } else if (args.size() == 2) {
+            productos = leerCatalogoCsv(args[0]);
+            salida = args[1];
+        } else {
+            mostrarUso(cerr, argv[0]);
+            return 2;
+        }
+        escribirCatalogoColumnar(productos, PRECIO_CARO, salida);
+        double segundos = duration<double>(steady_clock::now() - inicio).count();
+
+        // Se vuelve a abrir para validar el archivo y medir cuánto tarda la carga
+        SimuladorSupermercado sim(1);
+        auto t0 = steady_clock::now();
+        sim.cargarCatalogoColumnar(salida);
+        double carga = duration<double>(steady_clock::now() - t0).count();
+        cout << salida << ": " << sim.getInventario().size() << " productos, "
+             << sim.getInventario().nombresCategoria.size() << " categorías"
+             << (sim.getInventario().aliasBaratos.empty() && sim.getInventario().aliasCaros.empty()
+                 ? "" : ", con pesos") << endl;
+        cout << "Convertido en " << fixed << setprecision(3) << segundos << " s; se carga en "
+             << carga * 1e3 << " ms" << endl;
+    } catch (const exception& e) {
+        cerr << "Error: " << e.what() << endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,138 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+// Instantánea (checkpoint) de una simulación en curso, para seguirla después
+// de una interrupción. Ver SimuladorSupermercado::setInstantaneas.
+//
+// Cada cliente usa su propio flujo Philox (semilla, id), así que la posición
+// de todos los generadores queda dada por el próximo id a simular: no hay
+// estado de generador que guardar. El resto es el stock y los vendidos de
+// cada producto y los acumuladores de estadísticas, que son de tamaño fijo y
+// se copian tal cual. Por eso la instantánea solo se lee con el mismo
+// programa y la misma arquitectura; la cabecera guarda los tamaños para
+// rechazar las de otra versión.
+//
+// Archivo: CabeceraInstantanea, el acumulador, los totales y las columnas
+// stock y vendidos (int32 por producto). Se escribe en un temporal que
+// después se renombra, así una interrupción a mitad de escritura deja la
+// instantánea anterior intacta.
+
+constexpr char MAGIA_INSTANTANEA[8] = {'S', 'U', 'P', 'S', 'N', 'P', '0', '1'};
+constexpr uint32_t VERSION_INSTANTANEA = 1;
+
+struct CabeceraInstantanea {
+    char magia[8];
+    uint32_t version;
+    uint32_t modo;              // 1 secuencial, 2 mutex, 3 atómico, 4 fragmentado
+    uint64_t semilla;
+    uint64_t huella;            // del catálogo y los perfiles con que se simuló
+    int64_t totalClientes;
+    int64_t siguienteId;        // primer cliente que falta simular
+    int64_t clientesPorTramo;
+    uint32_t numProductos;
+    uint32_t bytesAcumulado;
+    uint32_t bytesTotales;
+    uint32_t reservado;
+    uint64_t suma;              // FNV-1a de todo lo que sigue a la cabecera
+};
+
+// FNV-1a de 64 bits; se encadena pasando el resultado anterior en h
+inline uint64_t fnv1a(const void* datos, size_t bytes, uint64_t h = 14695981039346656037ULL) {
+    const uint8_t* p = static_cast<const uint8_t*>(datos);
+    for (size_t i = 0; i < bytes; i++) {
+        h ^= p[i];
+        h *= 1099511628211ULL;
+    }
+    return h;
+}
+
+template <class Acumulado, class Totales>
+struct Instantanea {
+    static_assert(std::is_trivially_copyable<Acumulado>::value &&
+                  std::is_trivially_copyable<Totales>::value,
+                  "los acumuladores se guardan byte a byte");
+
+    CabeceraInstantanea cab{};
+    Acumulado acumulado;
+    Totales totales;
+    std::vector<int32_t> stock;
+    std::vector<int32_t> vendidos;
+
+    uint64_t calcularSuma() const {
+        uint64_t h = fnv1a(&acumulado, sizeof(acumulado));
+        h = fnv1a(&totales, sizeof(totales), h);
+        h = fnv1a(stock.data(), stock.size() * sizeof(int32_t), h);
+        return fnv1a(vendidos.data(), vendidos.size() * sizeof(int32_t), h);
+    }
+};
+
+template <class Acumulado, class Totales>
+inline void escribirInstantanea(const std::string& ruta, Instantanea<Acumulado, Totales>& inst) {
+    CabeceraInstantanea& cab = inst.cab;
+    std::memcpy(cab.magia, MAGIA_INSTANTANEA, sizeof(MAGIA_INSTANTANEA));
+    cab.version = VERSION_INSTANTANEA;
+    cab.numProductos = (uint32_t)inst.stock.size();
+    cab.bytesAcumulado = sizeof(Acumulado);
+    cab.bytesTotales = sizeof(Totales);
+    cab.suma = inst.calcularSuma();
+
+    std::string temporal = ruta + ".tmp";
+    std::FILE* f = std::fopen(temporal.c_str(), "wb");
+    if (!f) throw std::runtime_error("no se pudo crear " + temporal);
+    size_t n = cab.numProductos;
+    bool ok = std::fwrite(&cab, sizeof(cab), 1, f) == 1
+           && std::fwrite(&inst.acumulado, sizeof(Acumulado), 1, f) == 1
+           && std::fwrite(&inst.totales, sizeof(Totales), 1, f) == 1
+           && std::fwrite(inst.stock.data(), sizeof(int32_t), n, f) == n
+           && std::fwrite(inst.vendidos.data(), sizeof(int32_t), n, f) == n;
+    ok = (std::fclose(f) == 0) && ok;
+    if (!ok || std::rename(temporal.c_str(), ruta.c_str()) != 0) {
+        std::remove(temporal.c_str());
+        throw std::runtime_error("no se pudo escribir la instantánea " + ruta);
+    }
+}
+
+// Devuelve false si el archivo no existe; si existe pero no es una
+// instantánea válida de este programa para un catálogo de 'numProductos'
+// productos, lanza. El tamaño se comprueba antes de reservar las columnas,
+// así una cabecera dañada no pide memoria de más.
+template <class Acumulado, class Totales>
+inline bool leerInstantanea(const std::string& ruta, Instantanea<Acumulado, Totales>& inst,
+                            uint32_t numProductos) {
+    std::FILE* f = std::fopen(ruta.c_str(), "rb");
+    if (!f) return false;
+    auto fallar = [&](const std::string& motivo) {
+        std::fclose(f);
+        throw std::runtime_error(ruta + ": " + motivo);
+    };
+
+    CabeceraInstantanea& cab = inst.cab;
+    if (std::fread(&cab, sizeof(cab), 1, f) != 1 ||
+        std::memcmp(cab.magia, MAGIA_INSTANTANEA, sizeof(MAGIA_INSTANTANEA)) != 0)
+        fallar("no es una instantánea del simulador");
+    if (cab.version != VERSION_INSTANTANEA || cab.bytesAcumulado != sizeof(Acumulado) ||
+        cab.bytesTotales != sizeof(Totales))
+        fallar("instantánea de otra versión del programa");
+    if (cab.numProductos != numProductos)
+        fallar("la instantánea es de un catálogo de " + std::to_string(cab.numProductos) + " productos");
+
+    size_t n = cab.numProductos;
+    inst.stock.resize(n);
+    inst.vendidos.resize(n);
+    if (std::fread(&inst.acumulado, sizeof(Acumulado), 1, f) != 1 ||
+        std::fread(&inst.totales, sizeof(Totales), 1, f) != 1 ||
+        std::fread(inst.stock.data(), sizeof(int32_t), n, f) != n ||
+        std::fread(inst.vendidos.data(), sizeof(int32_t), n, f) != n)
+        fallar("instantánea truncada");
+    if (std::fgetc(f) != EOF) fallar("datos de más al final de la instantánea");
+    if (inst.calcularSuma() != cab.suma) fallar("la suma de verificación no coincide");
+    std::fclose(f);
+    return true;
+}
@@ -0,0 +1,74 @@
+#include "registro_transacciones.hpp"
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+
+using namespace std;
+using namespace std::chrono;
+
+// Lee un registro de transacciones (--transacciones del simulador), muestra
+// los totales y, con --csv, escribe una fila por línea de carrito con los
+// datos del cliente repetidos, ordenada por id de cliente.
+//
+//   ./leer_transacciones registro.trx [--csv lineas.csv]
+
+int main(int argc, char** argv) {
+    vector<string> args(argv + 1, argv + argc);
+    if (args.size() != 1 && !(args.size() == 3 && args[1] == "--csv")) {
+        cerr << "Uso: " << argv[0] << " REGISTRO [--csv SALIDA.csv]" << endl;
+        return 2;
+    }
+    try {
+        long long clientes = 0, lineas = 0, unidades = 0, centavos = 0, tarjeta = 0;
+        double tiempoCompra = 0;
+        map<int, long long> porTipo;
+        int idMinimo = INT32_MAX, idMaximo = 0;
+        vector<TransaccionLeida> todas;
+        bool csv = args.size() == 3;
+
+        auto inicio = steady_clock::now();
+        leerRegistroTransacciones(args[0], [&](const TransaccionLeida& t) {
+            clientes++;
+            lineas += t.lineas.size();
+            for (const auto& l : t.lineas) unidades += l.second;
+            centavos += t.totalCentavos;
+            tarjeta += t.tarjeta;
+            tiempoCompra += t.tiempoCompra;
+            porTipo[t.tipo]++;
+            idMinimo = min(idMinimo, t.id);
+            idMaximo = max(idMaximo, t.id);
+            if (csv) todas.push_back(t);
+        });
+        double segundos = duration<double>(steady_clock::now() - inicio).count();
+
+        cout << "Clientes: " << clientes << " (ids " << (clientes ? idMinimo : 0) << "-" << idMaximo << ")"
+             << " | Líneas: " << lineas << " | Unidades: " << unidades << endl;
+        cout << "Ventas: $" << fixed << setprecision(2) << centavos / 100.0
+             << " | Tarjeta: " << tarjeta << " | Efectivo: " << clientes - tarjeta
+             << " | Tiempo medio: " << (clientes ? tiempoCompra / clientes / 60 : 0.0) << " min" << endl;
+        for (const auto& pt : porTipo) cout << "  Tipo " << pt.first << ": " << pt.second << " clientes" << endl;
+        cout << "Leído en " << setprecision(3) << segundos << " s" << endl;
+
+        if (csv) {
+            sort(todas.begin(), todas.end(),
+                 [](const TransaccionLeida& a, const TransaccionLeida& b) { return a.id < b.id; });
+            ofstream f(args[2]);
+            if (!f) throw runtime_error("no se pudo escribir " + args[2]);
+            f << fixed << "cliente,tipo,metodo_pago,total,tiempo_compra_s,tiempo_pago_s,producto,cantidad\n";
+            for (const auto& t : todas) {
+                for (const auto& l : t.lineas) {
+                    f << t.id << "," << t.tipo << "," << (t.tarjeta ? "tarjeta" : "efectivo") << ","
+                      << setprecision(2) << t.totalCentavos / 100.0 << "," << setprecision(3)
+                      << t.tiempoCompra << "," << t.tiempoPago << "," << l.first << "," << l.second << "\n";
+                }
+            }
+            cout << "CSV generado: " << args[2] << endl;
+        }
+    } catch (const exception& e) {
+        cerr << "Error: " << e.what() << endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,21 @@
+#pragma once
+
+#include <cstddef>
+#include <new>
+
+// Separación mínima para que dos datos escritos por hilos distintos no
+// compartan línea de caché. Los programas se compilan como una sola unidad,
+// así que no importa que el valor cambie con el compilador o con -mtune.
+#ifdef __cpp_lib_hardware_interference_size
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Winterference-size"
+#endif
+constexpr std::size_t TAM_LINEA_CACHE = std::hardware_destructive_interference_size < 64
+                                      ? 64 : std::hardware_destructive_interference_size;
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+#else
+constexpr std::size_t TAM_LINEA_CACHE = 64;
+#endif
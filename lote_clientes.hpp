@@ -0,0 +1,322 @@
+#pragma once
+
+#include <cstdint>
+#include "philox.hpp"
+
+// Generación por lotes de la "cabecera" de cada cliente: tipo de comprador,
+// cantidad de productos, método de pago y tiempos. Son los valores que salen
+// de los bloques 0 y 1 del flujo Philox del cliente, así que se pueden
+// calcular para muchos clientes a la vez, un cliente por carril SIMD. Las
+// líneas del carrito siguen sorteándose cliente por cliente.
+//
+// Las tres implementaciones (escalar, AVX2 y AVX-512) dan resultados
+// idénticos: todas las conversiones a double son exactas (rangos enteros y
+// escalas por potencias de 2) y las comparaciones se hacen sobre los mismos
+// valores.
+
+// Dominio y bloques del flujo de cada cliente (ver philox::Flujo). El bloque 0
+// decide tipo, cantidad de productos, método y tiempo de pago; el 1 el tiempo
+// de selección; del 2 en adelante se consumen en orden para las líneas.
+constexpr uint32_t DOMINIO_CLIENTES = 0;
+constexpr uint32_t BLOQUE_CABECERA  = 0;
+constexpr uint32_t BLOQUE_TIEMPOS   = 1;
+constexpr uint32_t BLOQUE_LINEAS    = 2;
+
+struct PerfilComprador {
+    double umbral;          // probabilidad acumulada hasta este tipo
+    int minProductos;
+    int maxProductos;
+    double probProductoCaro; // probabilidad de elegir productos caros (>5.00)
+};
+
+constexpr int NUM_PERFILES = 4;
+constexpr PerfilComprador PERFILES[NUM_PERFILES] = {
+    {0.20,  1,  5, 0.1},    // 20% - Comprador pequeño (pocos productos, principalmente baratos)
+    {0.60,  5, 15, 0.3},    // 40% - Comprador promedio
+    {0.85, 15, 30, 0.4},    // 25% - Comprador familiar
+    {1.00, 30, 50, 0.5},    // 15% - Comprador grande/mayorista
+};
+
+constexpr int MAX_PERFILES = 16;   // un registro AVX-512 de enteros de 32 bits
+
+// Perfiles por columnas. El tipo de un cliente es la cantidad de umbrales
+// que su sorteo alcanza (sin saltos) y los datos del tipo se buscan por
+// índice, o con una permutación en las versiones SIMD. La de los perfiles
+// incorporados se arma al compilar; otra se puede cargar al arrancar (ver
+// PerfilArchivo en configuracion.hpp).
+struct TablaPerfiles {
+    int n = 0;
+    double umbral[MAX_PERFILES] = {};           // probabilidad acumulada; umbral[n-1] = 1
+    int32_t minProductos[MAX_PERFILES] = {};
+    int32_t maxProductos[MAX_PERFILES] = {};
+    int32_t rangoProductos[MAX_PERFILES] = {};  // max - min + 1
+    double probProductoCaro[MAX_PERFILES] = {};
+};
+
+template <int N>
+constexpr TablaPerfiles tablaDePerfiles(const PerfilComprador (&perfiles)[N]) {
+    static_assert(N >= 1 && N <= MAX_PERFILES, "cantidad de perfiles fuera de rango");
+    TablaPerfiles t;
+    t.n = N;
+    for (int i = 0; i < N; i++) {
+        t.umbral[i] = perfiles[i].umbral;
+        t.minProductos[i] = perfiles[i].minProductos;
+        t.maxProductos[i] = perfiles[i].maxProductos;
+        t.rangoProductos[i] = perfiles[i].maxProductos - perfiles[i].minProductos + 1;
+        t.probProductoCaro[i] = perfiles[i].probProductoCaro;
+    }
+    return t;
+}
+
+constexpr TablaPerfiles PERFILES_BASE = tablaDePerfiles(PERFILES);
+
+// Tipo de comprador para un sorteo u en [0, 1). Con N > 0 la cantidad de
+// perfiles se conoce al compilar y el bucle se desenrolla; con N = 0 se usa t.n.
+template <int N = 0>
+inline int elegirPerfil(const TablaPerfiles& t, double u) {
+    const int umbrales = (N > 0 ? N : t.n) - 1;
+    int tipo = 0;
+    for (int i = 0; i < umbrales; i++) tipo += (u >= t.umbral[i]);
+    return tipo;
+}
+
+constexpr double PROB_TARJETA     = 0.7;  // 70% tarjeta, 30% efectivo
+constexpr double FACTOR_TARJETA   = 0.8;  // pago con tarjeta es más rápido
+constexpr double PAGO_MIN         = 30,  PAGO_MAX      = 120;  // segundos
+constexpr double SELECCION_MIN    = 180, SELECCION_MAX = 600;  // 3-10 minutos
+
+constexpr int TAM_LOTE = 256;
+
+// Cabecera de un solo cliente, como la recibe el kernel de simulación
+struct CabeceraCliente {
+    int tipo;
+    int productos;
+    bool tarjeta;
+    double tiempoPago;          // ya incluye el factor de tarjeta
+    double tiempoSeleccion;
+    double probProductoCaro;    // del perfil del cliente
+};
+
+struct LoteCabeceras {
+    alignas(64) int32_t tipo[TAM_LOTE];
+    alignas(64) int32_t productos[TAM_LOTE];
+    alignas(64) int32_t tarjeta[TAM_LOTE];
+    alignas(64) double tiempoPago[TAM_LOTE];      // ya incluye el factor de tarjeta
+    alignas(64) double tiempoSeleccion[TAM_LOTE];
+
+    CabeceraCliente cabecera(int k, const TablaPerfiles& perfiles) const {
+        return {tipo[k], productos[k], tarjeta[k] != 0, tiempoPago[k], tiempoSeleccion[k],
+                perfiles.probProductoCaro[tipo[k]]};
+    }
+};
+
+enum class NivelSimd { Escalar, AVX2, AVX512 };
+
+inline const char* nombreNivelSimd(NivelSimd n) {
+    switch (n) {
+        case NivelSimd::AVX512: return "AVX-512";
+        case NivelSimd::AVX2:   return "AVX2";
+        default:                return "escalar";
+    }
+}
+
+inline NivelSimd detectarNivelSimd() {
+#ifdef PHILOX_X86
+    if (__builtin_cpu_supports("avx512f")) return NivelSimd::AVX512;
+    if (__builtin_cpu_supports("avx2"))    return NivelSimd::AVX2;
+#endif
+    return NivelSimd::Escalar;
+}
+
+// Cabeceras de los clientes [primerId + desde, primerId + hasta) en las
+// posiciones [desde, hasta) del lote. Es la referencia de los kernels SIMD.
+// N como en elegirPerfil.
+template <int N = 0>
+inline void generarCabecerasEscalar(uint64_t semilla, int primerId, int desde, int hasta,
+                                    LoteCabeceras& lote, const TablaPerfiles& perfiles) {
+    uint32_t k0 = (uint32_t)semilla, k1 = (uint32_t)(semilla >> 32);
+    for (int k = desde; k < hasta; k++) {
+        uint32_t id = (uint32_t)(primerId + k);
+        philox::Bloque b0 = philox::generar(BLOQUE_CABECERA, id, DOMINIO_CLIENTES, 0, k0, k1);
+        philox::Bloque b1 = philox::generar(BLOQUE_TIEMPOS,  id, DOMINIO_CLIENTES, 0, k0, k1);
+
+        int tipo = elegirPerfil<N>(perfiles, philox::uniforme01(b0.v[0]));
+
+        bool tarjeta = philox::uniforme01(b0.v[2]) < PROB_TARJETA;
+        double pago = philox::realEnRango(b0.v[3], PAGO_MIN, PAGO_MAX);
+        if (tarjeta) pago *= FACTOR_TARJETA;
+
+        lote.tipo[k] = tipo;
+        lote.productos[k] = philox::enteroEnRango(b0.v[1], perfiles.minProductos[tipo],
+                                                  perfiles.maxProductos[tipo]);
+        lote.tarjeta[k] = tarjeta;
+        lote.tiempoPago[k] = pago;
+        lote.tiempoSeleccion[k] = philox::realEnRango(b1.v[0], SELECCION_MIN, SELECCION_MAX);
+    }
+}
+
+#ifdef PHILOX_X86
+// u32 -> double exacto en [0, 1): AVX2 solo convierte enteros con signo, así
+// que se invierte el bit de signo y se suma 2^31 de vuelta.
+__attribute__((target("avx2")))
+inline __m256d uniforme01X4(__m128i x) {
+    __m256d d = _mm256_cvtepi32_pd(_mm_xor_si128(x, _mm_set1_epi32((int)0x80000000u)));
+    return _mm256_mul_pd(_mm256_add_pd(d, _mm256_set1_pd(2147483648.0)),
+                         _mm256_set1_pd(1.0 / 4294967296.0));
+}
+
+// Hasta 8 perfiles conocidos al compilar, las columnas de la tabla entran en
+// un registro y se buscan con una permutación; si no, con gather.
+template <int N = 0>
+__attribute__((target("avx2")))
+inline void generarCabecerasAVX2(uint64_t semilla, int primerId, int n, LoteCabeceras& lote,
+                                 const TablaPerfiles& perfiles) {
+    constexpr bool enRegistro = N > 0 && N <= 8;
+    const int umbrales = (N > 0 ? N : perfiles.n) - 1;
+    uint32_t k0 = (uint32_t)semilla, k1 = (uint32_t)(semilla >> 32);
+    const __m256i carril = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+    const __m256i tablaMin = _mm256_loadu_si256((const __m256i*)perfiles.minProductos);
+    const __m256i tablaRango = _mm256_loadu_si256((const __m256i*)perfiles.rangoProductos);
+
+    int k = 0;
+    for (; k + 8 <= n; k += 8) {
+        __m256i ids = _mm256_add_epi32(_mm256_set1_epi32(primerId + k), carril);
+        __m256i a0 = _mm256_set1_epi32(BLOQUE_CABECERA), a1 = ids;
+        __m256i a2 = _mm256_set1_epi32(DOMINIO_CLIENTES), a3 = _mm256_setzero_si256();
+        __m256i b0 = _mm256_set1_epi32(BLOQUE_TIEMPOS), b1 = ids;
+        __m256i b2 = _mm256_set1_epi32(DOMINIO_CLIENTES), b3 = _mm256_setzero_si256();
+        philox::generarX8(a0, a1, a2, a3, k0, k1);
+        philox::generarX8(b0, b1, b2, b3, k0, k1);
+
+        // Dos mitades de 4 carriles para las cuentas en double
+        for (int h = 0; h < 2; h++) {
+            __m128i w0 = h ? _mm256_extracti128_si256(a0, 1) : _mm256_castsi256_si128(a0);
+            __m128i w1 = h ? _mm256_extracti128_si256(a1, 1) : _mm256_castsi256_si128(a1);
+            __m128i w2 = h ? _mm256_extracti128_si256(a2, 1) : _mm256_castsi256_si128(a2);
+            __m128i w3 = h ? _mm256_extracti128_si256(a3, 1) : _mm256_castsi256_si128(a3);
+            __m128i v0 = h ? _mm256_extracti128_si256(b0, 1) : _mm256_castsi256_si128(b0);
+            int base = k + 4 * h;
+
+            __m256d u = uniforme01X4(w0);
+            __m128i tipo = _mm_setzero_si128();
+            for (int t = 0; t < umbrales; t++) {
+                __m256d ge = _mm256_cmp_pd(u, _mm256_set1_pd(perfiles.umbral[t]), _CMP_GE_OQ);
+                // la máscara AND 1.0 deja 1.0 o 0.0 por carril; se suma como entero
+                __m128i m = _mm256_cvtpd_epi32(_mm256_and_pd(ge, _mm256_set1_pd(1.0)));
+                tipo = _mm_add_epi32(tipo, m);
+            }
+            __m128i minP, rango;
+            if constexpr (enRegistro) {
+                __m256i tipo8 = _mm256_castsi128_si256(tipo);
+                minP = _mm256_castsi256_si128(_mm256_permutevar8x32_epi32(tablaMin, tipo8));
+                rango = _mm256_castsi256_si128(_mm256_permutevar8x32_epi32(tablaRango, tipo8));
+            } else {
+                minP = _mm_i32gather_epi32(perfiles.minProductos, tipo, 4);
+                rango = _mm_i32gather_epi32(perfiles.rangoProductos, tipo, 4);
+            }
+            __m256d sorteo = _mm256_floor_pd(_mm256_mul_pd(uniforme01X4(w1), _mm256_cvtepi32_pd(rango)));
+            __m128i productos = _mm_add_epi32(minP, _mm256_cvttpd_epi32(sorteo));
+
+            __m256d esTarjeta = _mm256_cmp_pd(uniforme01X4(w2), _mm256_set1_pd(PROB_TARJETA), _CMP_LT_OQ);
+            __m256d pago = _mm256_add_pd(_mm256_set1_pd(PAGO_MIN),
+                _mm256_mul_pd(_mm256_set1_pd(PAGO_MAX - PAGO_MIN), uniforme01X4(w3)));
+            pago = _mm256_blendv_pd(pago, _mm256_mul_pd(pago, _mm256_set1_pd(FACTOR_TARJETA)), esTarjeta);
+            __m128i tarjeta = _mm256_cvtpd_epi32(_mm256_and_pd(esTarjeta, _mm256_set1_pd(1.0)));
+            __m256d seleccion = _mm256_add_pd(_mm256_set1_pd(SELECCION_MIN),
+                _mm256_mul_pd(_mm256_set1_pd(SELECCION_MAX - SELECCION_MIN), uniforme01X4(v0)));
+
+            _mm_store_si128((__m128i*)&lote.tipo[base], tipo);
+            _mm_store_si128((__m128i*)&lote.productos[base], productos);
+            _mm_store_si128((__m128i*)&lote.tarjeta[base], tarjeta);
+            _mm256_store_pd(&lote.tiempoPago[base], pago);
+            _mm256_store_pd(&lote.tiempoSeleccion[base], seleccion);
+        }
+    }
+    generarCabecerasEscalar<N>(semilla, primerId, k, n, lote, perfiles);
+}
+
+__attribute__((target("avx512f")))
+inline __m512d uniforme01X8(__m256i x) {
+    return _mm512_mul_pd(_mm512_cvtepu32_pd(x), _mm512_set1_pd(1.0 / 4294967296.0));
+}
+
+// Las columnas de hasta MAX_PERFILES perfiles entran en un registro
+template <int N = 0>
+__attribute__((target("avx512f")))
+inline void generarCabecerasAVX512(uint64_t semilla, int primerId, int n, LoteCabeceras& lote,
+                                   const TablaPerfiles& perfiles) {
+    const int umbrales = (N > 0 ? N : perfiles.n) - 1;
+    uint32_t k0 = (uint32_t)semilla, k1 = (uint32_t)(semilla >> 32);
+    const __m512i carril = _mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+    const __m512i tablaMin = _mm512_loadu_si512(perfiles.minProductos);
+    const __m512i tablaRango = _mm512_loadu_si512(perfiles.rangoProductos);
+
+    int k = 0;
+    for (; k + 16 <= n; k += 16) {
+        __m512i ids = _mm512_add_epi32(_mm512_set1_epi32(primerId + k), carril);
+        __m512i a0 = _mm512_set1_epi32(BLOQUE_CABECERA), a1 = ids;
+        __m512i a2 = _mm512_set1_epi32(DOMINIO_CLIENTES), a3 = _mm512_setzero_si512();
+        __m512i b0 = _mm512_set1_epi32(BLOQUE_TIEMPOS), b1 = ids;
+        __m512i b2 = _mm512_set1_epi32(DOMINIO_CLIENTES), b3 = _mm512_setzero_si512();
+        philox::generarX16(a0, a1, a2, a3, k0, k1);
+        philox::generarX16(b0, b1, b2, b3, k0, k1);
+
+        for (int h = 0; h < 2; h++) {
+            __m256i w0 = h ? _mm512_extracti64x4_epi64(a0, 1) : _mm512_castsi512_si256(a0);
+            __m256i w1 = h ? _mm512_extracti64x4_epi64(a1, 1) : _mm512_castsi512_si256(a1);
+            __m256i w2 = h ? _mm512_extracti64x4_epi64(a2, 1) : _mm512_castsi512_si256(a2);
+            __m256i w3 = h ? _mm512_extracti64x4_epi64(a3, 1) : _mm512_castsi512_si256(a3);
+            __m256i v0 = h ? _mm512_extracti64x4_epi64(b0, 1) : _mm512_castsi512_si256(b0);
+            int base = k + 8 * h;
+
+            __m512d u = uniforme01X8(w0);
+            __m512i tipo = _mm512_setzero_si512();
+            for (int t = 0; t < umbrales; t++) {
+                __mmask8 ge = _mm512_cmp_pd_mask(u, _mm512_set1_pd(perfiles.umbral[t]), _CMP_GE_OQ);
+                tipo = _mm512_mask_add_epi64(tipo, ge, tipo, _mm512_set1_epi64(1));
+            }
+            __m256i tipo32 = _mm512_cvtepi64_epi32(tipo);
+            __m512i tipo16 = _mm512_castsi256_si512(tipo32);
+            __m256i minP = _mm512_castsi512_si256(_mm512_permutexvar_epi32(tipo16, tablaMin));
+            __m256i rango = _mm512_castsi512_si256(_mm512_permutexvar_epi32(tipo16, tablaRango));
+            __m512d sorteo = _mm512_roundscale_pd(_mm512_mul_pd(uniforme01X8(w1), _mm512_cvtepi32_pd(rango)),
+                                                  _MM_FROUND_TO_NEG_INF | _MM_FROUND_NO_EXC);
+            __m256i productos = _mm256_add_epi32(minP, _mm512_cvttpd_epi32(sorteo));
+
+            __mmask8 esTarjeta = _mm512_cmp_pd_mask(uniforme01X8(w2), _mm512_set1_pd(PROB_TARJETA), _CMP_LT_OQ);
+            __m512d pago = _mm512_add_pd(_mm512_set1_pd(PAGO_MIN),
+                _mm512_mul_pd(_mm512_set1_pd(PAGO_MAX - PAGO_MIN), uniforme01X8(w3)));
+            pago = _mm512_mask_mul_pd(pago, esTarjeta, pago, _mm512_set1_pd(FACTOR_TARJETA));
+            __m256i tarjeta = _mm512_cvtepi64_epi32(_mm512_maskz_set1_epi64(esTarjeta, 1));
+            __m512d seleccion = _mm512_add_pd(_mm512_set1_pd(SELECCION_MIN),
+                _mm512_mul_pd(_mm512_set1_pd(SELECCION_MAX - SELECCION_MIN), uniforme01X8(v0)));
+
+            _mm256_store_si256((__m256i*)&lote.tipo[base], tipo32);
+            _mm256_store_si256((__m256i*)&lote.productos[base], productos);
+            _mm256_store_si256((__m256i*)&lote.tarjeta[base], tarjeta);
+            _mm512_store_pd(&lote.tiempoPago[base], pago);
+            _mm512_store_pd(&lote.tiempoSeleccion[base], seleccion);
+        }
+    }
+    generarCabecerasEscalar<N>(semilla, primerId, k, n, lote, perfiles);
+}
+#endif
+
+template <int N>
+inline void generarCabecerasCon(uint64_t semilla, int primerId, int n, LoteCabeceras& lote,
+                                NivelSimd nivel, const TablaPerfiles& perfiles) {
+#ifdef PHILOX_X86
+    if (nivel == NivelSimd::AVX512) { generarCabecerasAVX512<N>(semilla, primerId, n, lote, perfiles); return; }
+    if (nivel == NivelSimd::AVX2)   { generarCabecerasAVX2<N>(semilla, primerId, n, lote, perfiles); return; }
+#endif
+    generarCabecerasEscalar<N>(semilla, primerId, 0, n, lote, perfiles);
+}
+
+// Llena las posiciones [0, n) del lote con los clientes primerId..primerId+n-1.
+// Una tabla con tantos perfiles como la incorporada usa las versiones
+// especializadas al compilar; cualquier otra, las genéricas.
+inline void generarCabeceras(uint64_t semilla, int primerId, int n, LoteCabeceras& lote,
+                             NivelSimd nivel, const TablaPerfiles& perfiles = PERFILES_BASE) {
+    if (perfiles.n == NUM_PERFILES) generarCabecerasCon<NUM_PERFILES>(semilla, primerId, n, lote, nivel, perfiles);
+    else generarCabecerasCon<0>(semilla, primerId, n, lote, nivel, perfiles);
+}
@@ -0,0 +1,199 @@
+#include "simulador_supermercado.hpp"
+#include <string>
+#include <vector>
+#include <iostream>
+#include <sstream>
+#include <fstream>
+#include <chrono>
+#include <iomanip>
+#include <algorithm>
+
+using namespace std;
+using namespace std::chrono;
+
+// Microbenchmark de falso compartir: mide el mismo trabajo con los datos
+// empaquetados (como estaban antes en el simulador) y con cada elemento en
+// su propia línea de caché (TAM_LINEA_CACHE), para 2 a 64 hilos.
+//
+//   contadores  cada hilo incrementa solo su contador
+//   mutex       lock por producto + stock/vendidos, como el modo mutex
+//   atomico     reserva con CAS por producto, como el modo atómico
+//
+// En 'mutex' y 'atomico' también hay contención real (dos hilos pueden
+// elegir el mismo producto); la diferencia entre columnas es lo que cuesta
+// que productos vecinos compartan línea.
+//
+//   ./metricas_falso_compartir [--hilos 2,4,8,16,32,64] [--operaciones N]
+//                              [--repeticiones N] [--productos N]
+
+static vector<int> HILOS = {2, 4, 8, 16, 32, 64};
+static long long OPERACIONES = 2000000;   // por hilo
+static int REPETICIONES = 5;
+static int PRODUCTOS = 50;
+static const string CSV_SALIDA = "metricas_falso_compartir.csv";
+
+struct ContadorRelleno {
+    alignas(TAM_LINEA_CACHE) atomic<long long> valor{0};
+};
+
+// Productos del modo mutex tal como estaban: los locks en un arreglo y el
+// stock y lo vendido en otros dos, todos contiguos
+struct StockEmpaquetado {
+    vector<mutex> locks;
+    vector<int> stock;
+    vector<int> vendidos;
+    explicit StockEmpaquetado(int n) : locks(n), stock(n, 1 << 30), vendidos(n, 0) {}
+};
+
+static inline uint32_t xorshift(uint32_t& x) {
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    return x;
+}
+
+// Segundos que tarda la región paralela de 'hilos' hilos; mediana de las repeticiones
+template <class Preparar, class Trabajo>
+static double medir(int hilos, Preparar preparar, Trabajo trabajo) {
+    vector<double> tiempos;
+    for (int r = 0; r < REPETICIONES; r++) {
+        preparar();
+        auto t0 = steady_clock::now();
+        #pragma omp parallel num_threads(hilos)
+        trabajo(omp_get_thread_num());
+        tiempos.push_back(duration<double>(steady_clock::now() - t0).count());
+    }
+    sort(tiempos.begin(), tiempos.end());
+    return tiempos[tiempos.size() / 2];
+}
+
+struct Fila {
+    string caso;
+    int hilos;
+    double empaquetado_ns;   // por operación, sumando todos los hilos
+    double alineado_ns;
+};
+
+static Fila medirContadores(int hilos) {
+    vector<atomic<long long>> empaquetados(hilos);
+    vector<ContadorRelleno> alineados(hilos);
+    double a = medir(hilos, [&]{ for (auto& c : empaquetados) c = 0; }, [&](int t) {
+        for (long long i = 0; i < OPERACIONES; i++)
+            empaquetados[t].store(empaquetados[t].load(memory_order_relaxed) + 1, memory_order_relaxed);
+    });
+    double b = medir(hilos, [&]{ for (auto& c : alineados) c.valor = 0; }, [&](int t) {
+        for (long long i = 0; i < OPERACIONES; i++)
+            alineados[t].valor.store(alineados[t].valor.load(memory_order_relaxed) + 1, memory_order_relaxed);
+    });
+    double ops = (double)OPERACIONES * hilos;
+    return {"contadores", hilos, a * 1e9 / ops, b * 1e9 / ops};
+}
+
+static Fila medirMutex(int hilos) {
+    StockEmpaquetado empaquetado(PRODUCTOS);
+    vector<ProductoBloqueado> alineado(PRODUCTOS);
+    auto reiniciar = [&] {
+        for (int p = 0; p < PRODUCTOS; p++) {
+            empaquetado.stock[p] = alineado[p].stock = 1 << 30;
+            empaquetado.vendidos[p] = alineado[p].vendidos = 0;
+        }
+    };
+    double a = medir(hilos, reiniciar, [&](int t) {
+        uint32_t x = 2463534242u + t * 7919u;
+        for (long long i = 0; i < OPERACIONES; i++) {
+            int p = xorshift(x) % PRODUCTOS;
+            lock_guard<mutex> g(empaquetado.locks[p]);
+            empaquetado.stock[p] -= 1;
+            empaquetado.vendidos[p] += 1;
+        }
+    });
+    double b = medir(hilos, reiniciar, [&](int t) {
+        uint32_t x = 2463534242u + t * 7919u;
+        for (long long i = 0; i < OPERACIONES; i++) {
+            ProductoBloqueado& prod = alineado[xorshift(x) % PRODUCTOS];
+            lock_guard<mutex> g(prod.m);
+            prod.stock -= 1;
+            prod.vendidos += 1;
+        }
+    });
+    double ops = (double)OPERACIONES * hilos;
+    return {"mutex", hilos, a * 1e9 / ops, b * 1e9 / ops};
+}
+
+static Fila medirAtomico(int hilos) {
+    vector<atomic<int>> empaquetado(PRODUCTOS);
+    vector<ContadorProductoAtomico> alineado(PRODUCTOS);
+    auto reiniciar = [&] {
+        for (int p = 0; p < PRODUCTOS; p++) empaquetado[p] = alineado[p].stock = 1 << 30;
+    };
+    auto tomar = [](atomic<int>& s) {
+        int actual = s.load(memory_order_relaxed);
+        while (actual > 0 && !s.compare_exchange_weak(actual, actual - 1, memory_order_relaxed)) {}
+    };
+    double a = medir(hilos, reiniciar, [&](int t) {
+        uint32_t x = 2463534242u + t * 7919u;
+        for (long long i = 0; i < OPERACIONES; i++) tomar(empaquetado[xorshift(x) % PRODUCTOS]);
+    });
+    double b = medir(hilos, reiniciar, [&](int t) {
+        uint32_t x = 2463534242u + t * 7919u;
+        for (long long i = 0; i < OPERACIONES; i++) tomar(alineado[xorshift(x) % PRODUCTOS].stock);
+    });
+    double ops = (double)OPERACIONES * hilos;
+    return {"atomico", hilos, a * 1e9 / ops, b * 1e9 / ops};
+}
+
+static vector<int> leerLista(const string& clave, const string& valor) {
+    vector<int> v;
+    stringstream ss(valor);
+    string item;
+    while (getline(ss, item, ',')) v.push_back((int)leerEntero(clave, recortar(item), 1, 4096));
+    if (v.empty()) throw invalid_argument("lista vacía para " + clave);
+    return v;
+}
+
+int main(int argc, char** argv) {
+    try {
+        for (int i = 1; i < argc; i++) {
+            string arg = argv[i];
+            if (i + 1 >= argc) throw invalid_argument("falta el valor de " + arg);
+            string valor = argv[++i];
+            if      (arg == "--hilos")        HILOS = leerLista(arg, valor);
+            else if (arg == "--operaciones")  OPERACIONES = leerEntero(arg, valor, 1, 1LL << 40);
+            else if (arg == "--repeticiones") REPETICIONES = (int)leerEntero(arg, valor, 1, 1000);
+            else if (arg == "--productos")    PRODUCTOS = (int)leerEntero(arg, valor, 1, 1000000);
+            else throw invalid_argument("opción desconocida: " + arg);
+        }
+    } catch (const exception& e) {
+        cerr << "Error: " << e.what() << endl;
+        cerr << "Uso: " << argv[0] << " [--hilos 2,4,8,16,32,64] [--operaciones N]"
+                " [--repeticiones N] [--productos N]" << endl;
+        return 2;
+    }
+
+    // Se quieren exactamente los hilos pedidos, aunque haya menos núcleos
+    omp_set_dynamic(0);
+    cout << "=== FALSO COMPARTIR ===" << endl;
+    cout << "Línea de caché: " << TAM_LINEA_CACHE << " bytes | Núcleos: " << omp_get_num_procs()
+         << " | Operaciones por hilo: " << OPERACIONES << " | Productos: " << PRODUCTOS << endl;
+    cout << "\n" << left << setw(12) << "Caso" << right << setw(6) << "Hilos"
+         << setw(18) << "empaquetado ns" << setw(16) << "alineado ns" << setw(10) << "razón" << endl;
+
+    vector<Fila> filas;
+    for (int h : HILOS) {
+        for (Fila f : {medirContadores(h), medirMutex(h), medirAtomico(h)}) {
+            cout << left << setw(12) << f.caso << right << setw(6) << f.hilos << fixed << setprecision(3)
+                 << setw(18) << f.empaquetado_ns << setw(16) << f.alineado_ns
+                 << setw(10) << (f.alineado_ns > 0 ? f.empaquetado_ns / f.alineado_ns : 0.0) << endl;
+            filas.push_back(f);
+        }
+    }
+
+    ofstream f(CSV_SALIDA);
+    f << "caso,hilos,empaquetado_ns,alineado_ns,razon\n";
+    for (const auto& r : filas) {
+        f << r.caso << "," << r.hilos << "," << fixed << setprecision(3) << r.empaquetado_ns << ","
+          << r.alineado_ns << "," << (r.alineado_ns > 0 ? r.empaquetado_ns / r.alineado_ns : 0.0) << "\n";
+    }
+    cout << "\nCSV generado: " << CSV_SALIDA << endl;
+    return 0;
+}
@@ -1,221 +1,375 @@
-#include <windows.h>
+#include "simulador_supermercado.hpp"
+#include "simulador_supermercado_secuencial.hpp"
 #include <string>
 #include <vector>
 #include <iostream>
 #include <sstream>
 #include <fstream>
 #include <chrono>
-#include <regex>
 #include <iomanip>
 #include <map>
 #include <algorithm>
-#include <thread>
+#include <cmath>
 
 using namespace std;
 using namespace std::chrono;
 
-static const string EXE_UNIFICADO = "simulador_supermercado.exe";
-static const string EXE_SECUENCIAL_PURO = "simulador_supermercado_secuencial.exe";
-static const vector<int> CLIENTES = {1000, 2000, 4000, 8000};
-static const vector<int> HILOS = {2, 4, 8, 0};
-static const int REPETICIONES = 3;
+// Banco de pruebas: corre los motores en el mismo proceso (sin lanzar
+// ejecutables ni leer su salida), con corridas de calentamiento y muchas
+// repeticiones medidas con steady_clock en nanosegundos. Cada fila del CSV
+// reporta la mediana y su dispersión; el speedup compara medianas.
+//
+// Con --contadores si, cada configuración hace además una corrida aparte (sin
+// cronometrar) con contadores de hardware por fase y por hilo, que van a
+// metricas_contadores.csv y a una sección del HTML.
+//
+// --planificacion repite los modos paralelos con cada reparto de lotes
+// pedido; las filas que no son estáticas llevan el reparto en el modo
+// (por ejemplo "atomico/robo").
+//
+// Cada corrida paralela anota en qué CPU y nodo NUMA quedó cada hilo; el
+// reparto por nodo de la última repetición va a metricas_nodos.csv y al
+// HTML. --afinidad compacta|dispersa fija los hilos (ver afinidad_numa.hpp).
+//
+// Con --contencion si, cada configuración en modo mutex ("par") hace una
+// corrida aparte con los locks por producto instrumentados; los productos con
+// tomas contendidas van a metricas_locks.csv y a un mapa de calor del HTML.
+//
+//   ./metricas_supermercado [--repeticiones N] [--calentamiento N]
+//                           [--clientes 1000,2000] [--hilos 2,4,0]
+//                           [--planificacion estatica,robo] [--contadores si]
+//                           [--afinidad compacta] [--contencion si]
+
+static vector<int> CLIENTES = {1000, 2000, 4000, 8000};
+static vector<int> HILOS = {2, 4, 8, 0};
+static int CALENTAMIENTO = 3;
+static int REPETICIONES = 21;
+static const uint64_t SEMILLA = 20240601;   // misma carga en todas las corridas
 static const string CSV_SALIDA  = "metricas_resultados.csv";
 static const string HTML_SALIDA = "metricas_reporte.html";
+static const string CSV_CONTADORES = "metricas_contadores.csv";
+static const string CSV_NODOS = "metricas_nodos.csv";
+static const string CSV_LOCKS = "metricas_locks.csv";
+static bool CONTADORES = false;
+static bool CONTENCION = false;
+static vector<string> NOMBRES_PRODUCTOS;    // del catálogo, para la contención
+static vector<Planificacion> PLANIFICACIONES = {Planificacion::Estatica};
+static Afinidad AFINIDAD = Afinidad::Ninguna;
+
+struct Medicion {
+    int64_t simulacion_ns = 0;
+    int64_t analisis_ns = 0;
+    vector<EstadisticasHilo> reparto;   // vacío en los modos secuenciales
+};
 
 struct Resultado {
     int clientes = 0;
     string modo;
     int hilos = 1;
-    double tiempo_s = 0.0;
+    double tiempo_s = 0.0;      // mediana
+    double analisis_s = 0.0;    // mediana del análisis posterior
+    int repeticiones = 0;
+    double media_s = 0.0;
+    double desviacion_s = 0.0;
+    double p05_s = 0.0;
+    double p95_s = 0.0;
+    double ic95_inf_s = 0.0;    // intervalo de confianza de la mediana
+    double ic95_sup_s = 0.0;
+    PerfilHw perfil;            // solo con --contadores
+    PerfilLocks locks;          // solo con --contencion, en modo mutex
+    vector<ResumenNodo> nodos;  // de la última repetición
 };
 
-static bool run_process_with_input(const string& exePath,
-                                   const string& stdinText,
-                                   string& stdoutText,
-                                   double& wallSeconds)
+// Percentil p (0-100) con interpolación lineal entre muestras ordenadas
+static double percentil(const vector<int64_t>& ordenadas, double p)
 {
-    SECURITY_ATTRIBUTES sa{}; sa.nLength = sizeof(sa); sa.bInheritHandle = TRUE;
-    HANDLE hInRead=nullptr, hInWrite=nullptr, hOutRead=nullptr, hOutWrite=nullptr;
-    if (!CreatePipe(&hInRead, &hInWrite, &sa, 0)) return false;
-    if (!SetHandleInformation(hInWrite, HANDLE_FLAG_INHERIT, 0)) return false;
-    if (!CreatePipe(&hOutRead, &hOutWrite, &sa, 0)) return false;
-    if (!SetHandleInformation(hOutRead, HANDLE_FLAG_INHERIT, 0)) return false;
-    STARTUPINFOA si{};
-    si.cb = sizeof(si);
-    si.hStdInput  = hInRead;
-    si.hStdOutput = hOutWrite;
-    si.hStdError  = hOutWrite;
-    si.dwFlags    = STARTF_USESTDHANDLES;
-    PROCESS_INFORMATION pi{};
-    string cmd = "\"" + exePath + "\"";
-    vector<char> cmdline(cmd.begin(), cmd.end());
-    cmdline.push_back('\0');
-    auto t0 = high_resolution_clock::now();
-    BOOL ok = CreateProcessA(
-        NULL, cmdline.data(), NULL, NULL, TRUE,
-        CREATE_NO_WINDOW, NULL, NULL, &si, &pi);
-    CloseHandle(hInRead);
-    CloseHandle(hOutWrite);
-    if (!ok) {
-        CloseHandle(hInWrite);
-        CloseHandle(hOutRead);
-        return false;
+    if (ordenadas.empty()) return 0.0;
+    double pos = (ordenadas.size() - 1) * p / 100.0;
+    size_t i = (size_t)pos;
+    if (i + 1 >= ordenadas.size()) return (double)ordenadas.back();
+    double f = pos - i;
+    return ordenadas[i] + f * (ordenadas[i + 1] - ordenadas[i]);
+}
+
+// Resume las muestras. El IC 95% de la mediana sale de los estadísticos de
+// orden (no supone normalidad): rangos n/2 -/+ 1.96*sqrt(n)/2.
+static void resumir(const vector<Medicion>& muestras, Resultado& res)
+{
+    vector<int64_t> sim, ana;
+    for (const auto& m : muestras) {
+        sim.push_back(m.simulacion_ns);
+        ana.push_back(m.analisis_ns);
     }
-    string norm = stdinText;
-    for (size_t i = 0; i < norm.size(); ++i) {
-        if (norm[i] == '\n') {
-            if (i == 0 || norm[i-1] != '\r') {
-                norm.insert(i, "\r");
-                ++i;
-            }
-        }
+    sort(sim.begin(), sim.end());
+    sort(ana.begin(), ana.end());
+    int n = (int)sim.size();
+
+    double suma = 0.0;
+    for (int64_t t : sim) suma += t;
+    double media = suma / n;
+    double m2 = 0.0;
+    for (int64_t t : sim) m2 += (t - media) * (t - media);
+
+    double mitad = 1.96 * sqrt((double)n) / 2.0;
+    int j = max(1, (int)floor(n / 2.0 - mitad));
+    int k = min(n, (int)ceil(n / 2.0 + 1.0 + mitad));
+
+    res.repeticiones = n;
+    res.tiempo_s     = percentil(sim, 50) * 1e-9;
+    res.analisis_s   = percentil(ana, 50) * 1e-9;
+    res.media_s      = media * 1e-9;
+    res.desviacion_s = (n > 1 ? sqrt(m2 / (n - 1)) : 0.0) * 1e-9;
+    res.p05_s        = percentil(sim, 5) * 1e-9;
+    res.p95_s        = percentil(sim, 95) * 1e-9;
+    res.ic95_inf_s   = sim[j - 1] * 1e-9;
+    res.ic95_sup_s   = sim[k - 1] * 1e-9;
+}
+
+template <class Corrida>
+static Resultado medir(int clientes, const string& modo, int hilos, Corrida corrida)
+{
+    for (int r = 0; r < CALENTAMIENTO; ++r) corrida();
+    vector<Medicion> muestras;
+    muestras.reserve(REPETICIONES);
+    for (int r = 0; r < REPETICIONES; ++r) muestras.push_back(corrida());
+    Resultado res;
+    res.clientes = clientes;
+    res.modo = modo;
+    res.hilos = hilos;
+    resumir(muestras, res);
+    res.nodos = resumirPorNodo(muestras.back().reparto);
+    return res;
+}
+
+static int64_t nanosegundos(steady_clock::duration d)
+{
+    return duration_cast<nanoseconds>(d).count();
+}
+
+// Una corrida del simulador unificado. Solo se mide la simulación y, aparte,
+// el análisis; crear el catálogo queda fuera.
+static Medicion correrUnificado(int clientes, int modo, int hilos, PerfilHw* perfil = nullptr,
+                                Planificacion plan = Planificacion::Estatica, PerfilLocks* locks = nullptr)
+{
+    SimuladorSupermercado sim(SEMILLA);
+    sim.setVerboso(false);
+    sim.setPlanificacion(plan);
+    sim.setAfinidad(AFINIDAD);
+    if (perfil) {
+        sim.setMedirContadores(true);
+        sim.inicializarInventario();
     }
-    DWORD written=0;
-    if (!stdinText.empty()) {
-        WriteFile(hInWrite, norm.data(), (DWORD)norm.size(), &written, NULL);
+    if (locks) sim.setMedirLocks(true);
+    auto t0 = steady_clock::now();
+    if (modo == 1) {
+        sim.ejecutarSimulacion(clientes);
+    } else {
+        ModoStock modoStock = (modo == 3) ? ModoStock::Atomico
+                            : (modo == 4) ? ModoStock::Fragmentado
+                            : ModoStock::Mutex;
+        sim.ejecutarSimulacionOMP(clientes, hilos, modoStock);
     }
-    CloseHandle(hInWrite);
-    const DWORD BUFSZ = 1<<12;
-    char buf[BUFSZ];
-    DWORD read=0;
-    stdoutText.clear();
-    for (;;) {
-        BOOL okr = ReadFile(hOutRead, buf, BUFSZ, &read, NULL);
-        if (!okr || read == 0) break;
-        stdoutText.append(buf, buf + read);
+    auto t1 = steady_clock::now();
+    sim.analizarResultados();
+    auto t2 = steady_clock::now();
+    if (perfil) *perfil = *sim.getPerfilHw();
+    if (locks) {
+        *locks = *sim.getPerfilLocks();
+        if (NOMBRES_PRODUCTOS.empty()) {
+            const Catalogo& cat = sim.getInventario();
+            for (int p = 0; p < cat.size(); p++) NOMBRES_PRODUCTOS.emplace_back(cat.nombre[p]);
+        }
     }
-    WaitForSingleObject(pi.hProcess, INFINITE);
-    auto t1 = high_resolution_clock::now();
-    wallSeconds = duration<double>(t1 - t0).count();
-    CloseHandle(hOutRead);
-    CloseHandle(pi.hThread);
-    CloseHandle(pi.hProcess);
-    return true;
+    return {nanosegundos(t1 - t0), nanosegundos(t2 - t1), sim.getRepartoHilos()};
 }
 
-static double parse_seconds_from_output(const string& out)
+static Medicion correrSecuencialPuro(int clientes)
 {
-    std::regex rgx(
-        "(Simulaci[oó]n\\s+completada\\s+en\\s+)([0-9]+(?:[\\.,][0-9]+)?)\\s+segundos",
-        std::regex::icase);
-    std::smatch m;
-    if (std::regex_search(out, m, rgx) && m.size() >= 3) {
-        string num = m[2].str();
-        for (char& c : num) if (c == ',') c = '.';
-        try {
-            return std::stod(num);
-        } catch (...) {}
-    }
-    return -1.0;
+    puro::SimuladorSupermercado sim(SEMILLA);
+    sim.setVerboso(false);
+    auto t0 = steady_clock::now();
+    sim.ejecutarSimulacion(clientes);
+    auto t1 = steady_clock::now();
+    return {nanosegundos(t1 - t0), 0, {}};
+}
+
+static vector<int> leerLista(const string& clave, const string& valor, long long minimo)
+{
+    vector<int> v;
+    stringstream ss(valor);
+    string item;
+    while (getline(ss, item, ',')) v.push_back((int)leerEntero(clave, recortar(item), minimo, 100000000LL));
+    if (v.empty()) throw invalid_argument("lista vacía para " + clave);
+    return v;
 }
 
-static string make_stdin_unificado(int clientes, int modo, int hilos)
+static vector<Planificacion> leerPlanificaciones(const string& valor)
 {
-    ostringstream ss;
-    ss << clientes << "\n";
-    ss << modo << "\n";
-    if (modo == 2) ss << hilos << "\n";
-    ss << "\n";
-    return ss.str();
+    vector<Planificacion> v;
+    stringstream ss(valor);
+    string item;
+    while (getline(ss, item, ',')) v.push_back(leerPlanificacion(recortar(item)));
+    if (v.empty()) throw invalid_argument("lista vacía para --planificacion");
+    return v;
 }
 
-static string make_stdin_secuencial_puro(int clientes)
+static void imprimirFila(const string& etiqueta, const Resultado& r)
 {
-    ostringstream ss;
-    ss << clientes << "\n";
-    ss << "\n";
-    return ss.str();
+    cout << etiqueta << " | N=" << setw(5) << r.clientes << "  H=" << setw(2) << r.hilos
+         << "  mediana=" << fixed << setprecision(6) << r.tiempo_s << " s"
+         << "  IC95=[" << r.ic95_inf_s << ", " << r.ic95_sup_s << "]"
+         << "  p95=" << r.p95_s << endl;
 }
 
-int main()
+int main(int argc, char** argv)
 {
+    try {
+        for (int i = 1; i < argc; i++) {
+            string arg = argv[i];
+            if (i + 1 >= argc) throw invalid_argument("falta el valor de " + arg);
+            string valor = argv[++i];
+            if      (arg == "--repeticiones")  REPETICIONES  = (int)leerEntero(arg, valor, 1, 100000);
+            else if (arg == "--calentamiento") CALENTAMIENTO = (int)leerEntero(arg, valor, 0, 100000);
+            else if (arg == "--clientes")      CLIENTES = leerLista(arg, valor, 1);
+            else if (arg == "--hilos")         HILOS = leerLista(arg, valor, 0);
+            else if (arg == "--contadores")    CONTADORES = (valor == "si" || valor == "sí" || valor == "1");
+            else if (arg == "--planificacion") PLANIFICACIONES = leerPlanificaciones(valor);
+            else if (arg == "--afinidad")      AFINIDAD = leerAfinidad(valor);
+            else if (arg == "--contencion")    CONTENCION = (valor == "si" || valor == "sí" || valor == "1");
+            else throw invalid_argument("opción desconocida: " + arg);
+        }
+    } catch (const exception& e) {
+        cerr << "Error: " << e.what() << endl;
+        cerr << "Uso: " << argv[0] << " [--repeticiones N] [--calentamiento N]"
+                " [--clientes 1000,2000] [--hilos 2,4,0]"
+                " [--planificacion estatica,dinamica,guiada,robo] [--contadores si]"
+                " [--afinidad no|compacta|dispersa] [--contencion si]" << endl;
+        return 2;
+    }
+
     ios::sync_with_stdio(false);
-    cout << "=== METRICAS SUPERMERCADO (Windows) ===" << endl;
+    cout << "=== METRICAS SUPERMERCADO ===" << endl;
+    cout << "Calentamiento: " << CALENTAMIENTO << " | Repeticiones: " << REPETICIONES
+         << " | Semilla: " << SEMILLA << endl;
+    if (CONTADORES) cout << "Contadores disponibles: " << ContadoresHw::diagnostico() << endl;
+    cout << "Nodos NUMA: " << topologiaNuma().numNodos() << " | Afinidad: "
+         << (afinidadDelRuntime() ? "del runtime (OMP_PROC_BIND)" : nombreAfinidad(AFINIDAD)) << endl;
     vector<Resultado> resultados;
     {
-        cout << "\n>> Ejecutando con: " << EXE_UNIFICADO << endl;
+        cout << "\n>> Simulador unificado" << endl;
+        const struct { int modo; const char* nombre; const char* etiqueta; } PARALELOS[] = {
+            {2, "par", "PAR "}, {3, "atomico", "ATOM"}, {4, "fragmentado", "FRAG"},
+        };
         for (int clientes : CLIENTES) {
-            {
-                double acumulado = 0.0;
-                for (int r = 0; r < REPETICIONES; ++r) {
-                    string out; double wall=0;
-                    string in = make_stdin_unificado(clientes, 1, 1);
-                    bool ok = run_process_with_input(EXE_UNIFICADO, in, out, wall);
-                    if (!ok) { cerr << "Error lanzando " << EXE_UNIFICADO << " (sec)\n"; return 1; }
-                    double t = parse_seconds_from_output(out);
-                    if (t < 0) t = wall;
-                    acumulado += t;
-                }
-                Resultado res;
-                res.clientes = clientes;
-                res.modo = "sec";
-                res.hilos = 1;
-                res.tiempo_s = acumulado / REPETICIONES;
-                resultados.push_back(res);
-                cout << "SEC  | N=" << setw(5) << clientes << "  t=" << fixed << setprecision(3) << res.tiempo_s << " s" << endl;
-            }
-            for (int h : HILOS) {
-                double acumulado = 0.0;
-                for (int r = 0; r < REPETICIONES; ++r) {
-                    string out; double wall=0;
-                    string in = make_stdin_unificado(clientes, 2, h);
-                    bool ok = run_process_with_input(EXE_UNIFICADO, in, out, wall);
-                    if (!ok) { cerr << "Error lanzando " << EXE_UNIFICADO << " (par)\n"; return 1; }
-                    double t = parse_seconds_from_output(out);
-                    if (t < 0) t = wall;
-                    acumulado += t;
+            Resultado sec = medir(clientes, "sec", 1,
+                                  [&]{ return correrUnificado(clientes, 1, 1); });
+            if (CONTADORES) correrUnificado(clientes, 1, 1, &sec.perfil);
+            resultados.push_back(sec);
+            imprimirFila("SEC ", sec);
+            for (const auto& p : PARALELOS) {
+                for (Planificacion plan : PLANIFICACIONES) {
+                    string nombre = p.nombre;
+                    if (plan != Planificacion::Estatica) nombre += string("/") + nombrePlanificacion(plan);
+                    for (int h : HILOS) {
+                        int hilos = (h == 0 ? omp_get_max_threads() : h);
+                        Resultado res = medir(clientes, nombre, hilos,
+                                              [&]{ return correrUnificado(clientes, p.modo, hilos, nullptr, plan); });
+                        if (CONTADORES) correrUnificado(clientes, p.modo, hilos, &res.perfil, plan);
+                        if (CONTENCION && p.modo == 2) correrUnificado(clientes, p.modo, hilos, nullptr, plan, &res.locks);
+                        resultados.push_back(res);
+                        imprimirFila(string(p.etiqueta) + (plan == Planificacion::Estatica ? "" : string(" ") + nombrePlanificacion(plan)), res);
+                    }
                 }
-                Resultado res;
-                res.clientes = clientes;
-                res.modo = "par";
-                res.hilos = (h == 0 ? max(2u, thread::hardware_concurrency()) : h);
-                res.tiempo_s = acumulado / REPETICIONES;
-                resultados.push_back(res);
-                cout << "PAR  | N=" << setw(5) << clientes << "  H=" << setw(2) << (h==0?res.hilos:h)
-                     << "  t=" << fixed << setprecision(3) << res.tiempo_s << " s" << endl;
             }
         }
     }
-    if (!EXE_SECUENCIAL_PURO.empty()) {
-        cout << "\n>> Ejecutando con (secuencial puro): " << EXE_SECUENCIAL_PURO << endl;
+    {
+        cout << "\n>> Simulador secuencial puro" << endl;
         for (int clientes : CLIENTES) {
-            double acumulado = 0.0;
-            for (int r = 0; r < REPETICIONES; ++r) {
-                string out; double wall=0;
-                string in = make_stdin_secuencial_puro(clientes);
-                bool ok = run_process_with_input(EXE_SECUENCIAL_PURO, in, out, wall);
-                if (!ok) { cerr << "Error lanzando " << EXE_SECUENCIAL_PURO << "\n"; return 1; }
-                double t = parse_seconds_from_output(out);
-                if (t < 0) t = wall;
-                acumulado += t;
-            }
-            Resultado res;
-            res.clientes = clientes;
-            res.modo = "sec_puro";
-            res.hilos = 1;
-            res.tiempo_s = acumulado / REPETICIONES;
+            Resultado res = medir(clientes, "sec_puro", 1,
+                                  [&]{ return correrSecuencialPuro(clientes); });
             resultados.push_back(res);
-            cout << "SEC* | N=" << setw(5) << clientes << "  t=" << fixed << setprecision(3) << res.tiempo_s << " s" << endl;
+            imprimirFila("SEC*", res);
         }
     }
     map<int,double> baseSec;
     for (auto& r : resultados) {
         if (r.modo == "sec") baseSec[r.clientes] = r.tiempo_s;
     }
+    auto speedupDe = [&](const Resultado& r) {
+        return (baseSec.count(r.clientes) && r.tiempo_s > 0) ? (baseSec[r.clientes] / r.tiempo_s) : 0.0;
+    };
+    auto eficienciaDe = [&](const Resultado& r) {
+        return (r.modo == "sec_puro") ? 0.0 : speedupDe(r) / r.hilos;
+    };
     {
         ofstream f(CSV_SALIDA);
-        f << "clientes,modo,hilos,tiempo_s,speedup,eficiencia\n";
+        f << "clientes,modo,hilos,tiempo_s,speedup,eficiencia,analisis_s,repeticiones,"
+             "media_s,desviacion_s,p05_s,p95_s,ic95_inf_s,ic95_sup_s\n";
         for (auto& r : resultados) {
-            double speedup = (baseSec.count(r.clientes) && r.tiempo_s > 0)
-                             ? (baseSec[r.clientes] / r.tiempo_s) : 0.0;
-            double eff = (r.modo == "par" && r.hilos > 1) ? (speedup / r.hilos) : (r.modo=="sec"?1.0:0.0);
             f << r.clientes << "," << r.modo << "," << r.hilos << ","
-              << fixed << setprecision(6) << r.tiempo_s << ","
-              << fixed << setprecision(6) << speedup << ","
-              << fixed << setprecision(6) << eff << "\n";
+              << fixed << setprecision(9) << r.tiempo_s << ","
+              << fixed << setprecision(6) << speedupDe(r) << ","
+              << fixed << setprecision(6) << eficienciaDe(r) << ","
+              << fixed << setprecision(9) << r.analisis_s << ","
+              << r.repeticiones << ","
+              << r.media_s << "," << r.desviacion_s << ","
+              << r.p05_s << "," << r.p95_s << ","
+              << r.ic95_inf_s << "," << r.ic95_sup_s << "\n";
         }
     }
     cout << "\nCSV generado: " << CSV_SALIDA << endl;
+    if (CONTADORES) {
+        // Una fila por configuración, fase e hilo; vacío = evento no disponible
+        ofstream f(CSV_CONTADORES);
+        f << "clientes,modo,hilos,fase,hilo,tiempo_ns";
+        for (int e = 0; e < NUM_EVENTOS_HW; e++) f << "," << nombreEventoHw(e);
+        f << "\n";
+        for (auto& r : resultados) {
+            for (size_t t = 0; t < r.perfil.porHilo.size(); t++) {
+                for (int fase = 0; fase < NUM_FASES; fase++) {
+                    const LecturaHw& l = r.perfil.porHilo[t][fase];
+                    if (l.nanosegundos == 0) continue;
+                    f << r.clientes << "," << r.modo << "," << r.hilos << ","
+                      << nombreFase(fase) << "," << t << "," << l.nanosegundos;
+                    for (int e = 0; e < NUM_EVENTOS_HW; e++) {
+                        f << ",";
+                        if (l.disponible[e]) f << l.valor[e];
+                    }
+                    f << "\n";
+                }
+            }
+        }
+        cout << "CSV generado: " << CSV_CONTADORES << endl;
+    }
+    if (CONTENCION) {
+        // Una fila por configuración y producto con alguna toma contendida
+        ofstream f(CSV_LOCKS);
+        f << "clientes,modo,hilos,producto,nombre,adquisiciones,contendidas,espera_ns,p50_ns,p90_ns,p99_ns\n";
+        for (auto& r : resultados) {
+            const PerfilLocks& pl = r.locks;
+            for (int p : pl.masContendidos((int)pl.productos.size())) {
+                const ContencionProducto& c = pl.productos[p];
+                f << r.clientes << "," << r.modo << "," << r.hilos << "," << p << ","
+                  << NOMBRES_PRODUCTOS[p] << "," << c.adquisiciones << "," << c.contendidas << ","
+                  << fixed << setprecision(0) << pl.esperaNs(c) << "," << pl.percentilNs(c, 50) << ","
+                  << pl.percentilNs(c, 90) << "," << pl.percentilNs(c, 99) << "\n";
+            }
+        }
+        cout << "CSV generado: " << CSV_LOCKS << endl;
+    }
+    {
+        ofstream f(CSV_NODOS);
+        f << "clientes,modo,hilos,nodo,hilos_nodo,lotes,ocupado_s,ocioso_s\n";
+        for (auto& r : resultados) {
+            for (const auto& rn : r.nodos) {
+                f << r.clientes << "," << r.modo << "," << r.hilos << "," << rn.nodo << ","
+                  << rn.hilos << "," << rn.tareas << "," << fixed << setprecision(6)
+                  << rn.ocupado << "," << rn.ocioso << "\n";
+            }
+        }
+        cout << "CSV generado: " << CSV_NODOS << endl;
+    }
     auto html_escape = [](const string& s)->string {
         string o; o.reserve(s.size()*1.1);
         for (char c : s) {
@@ -233,32 +387,142 @@ int main()
     map<int, vector<Resultado>> porN;
     for (auto& r : resultados) porN[r.clientes].push_back(r);
     double tmax = 0.0;
-    for (auto& r : resultados) tmax = max(tmax, r.tiempo_s);
+    for (auto& r : resultados) tmax = max(tmax, r.ic95_sup_s);
     ofstream h(HTML_SALIDA);
     h << "<!doctype html><meta charset='utf-8'>\n";
     h << "<title>Métricas Supermercado</title>\n";
     h << "<style>body{font-family:Segoe UI,Arial,sans-serif;margin:24px}"
          ".card{border:1px solid #ddd;border-radius:10px;padding:16px;margin-bottom:20px}"
          "table{border-collapse:collapse;width:100%}th,td{border:1px solid #ddd;padding:6px;text-align:center}"
-         "th{background:#f7f7f7} .tag{display:inline-block;padding:2px 8px;border-radius:12px;background:#eee;margin-left:6px;font-size:12px}"
+         "th{background:#f7f7f7} .calor th.sku{writing-mode:vertical-rl;transform:rotate(180deg);font-weight:normal;font-size:12px}"
+         ".calor td{font-size:12px;padding:4px} .tag{display:inline-block;padding:2px 8px;border-radius:12px;background:#eee;margin-left:6px;font-size:12px}"
          "</style>\n";
     h << "<h1>Métricas de ejecución</h1>\n";
-    h << "<p>Este reporte compara tiempos de ejecución secuencial vs paralelo (OpenMP) y calcula speedup/eficiencia. "
+    h << "<p>Este reporte compara tiempos de ejecución secuencial vs paralelo (OpenMP) y calcula speedup/eficiencia "
+         "sobre la <b>mediana</b> de " << REPETICIONES << " repeticiones (tras " << CALENTAMIENTO
+      << " de calentamiento), medidas en el mismo proceso con resolución de nanosegundos. "
+         "El tiempo de análisis (agregados, top 10 e inventario) se mide aparte y no entra en el speedup. "
          "Datos exportados también a <b>" << html_escape(CSV_SALIDA) << "</b>.</p>\n";
-    h << "<div class='card'><h2>Resumen (promedios de " << REPETICIONES << " corridas)</h2>\n";
-    h << "<table><tr><th>Clientes</th><th>Modo</th><th>Hilos</th><th>Tiempo (s)</th><th>Speedup</th><th>Eficiencia</th></tr>\n";
+    h << "<div class='card'><h2>Resumen (medianas de " << REPETICIONES << " corridas)</h2>\n";
+    h << "<table><tr><th>Clientes</th><th>Modo</th><th>Hilos</th><th>Mediana (ms)</th><th>IC 95% (ms)</th>"
+         "<th>p5–p95 (ms)</th><th>Speedup</th><th>Eficiencia</th><th>Análisis (ms)</th></tr>\n";
     for (auto& r : resultados) {
-        double speedup = (baseSec.count(r.clientes) && r.tiempo_s > 0)
-                         ? (baseSec[r.clientes] / r.tiempo_s) : 0.0;
-        double eff = (r.modo == "par" && r.hilos > 1) ? (speedup / r.hilos) : (r.modo=="sec"?1.0:0.0);
         h << "<tr><td>" << r.clientes << "</td>"
           << "<td>" << r.modo << "</td>"
           << "<td>" << r.hilos << "</td>"
-          << "<td>" << fixed << setprecision(3) << r.tiempo_s << "</td>"
-          << "<td>" << fixed << setprecision(3) << speedup << "</td>"
-          << "<td>" << fixed << setprecision(3) << eff << "</td></tr>\n";
+          << "<td>" << fixed << setprecision(3) << r.tiempo_s * 1e3 << "</td>"
+          << "<td>" << r.ic95_inf_s * 1e3 << " – " << r.ic95_sup_s * 1e3 << "</td>"
+          << "<td>" << r.p05_s * 1e3 << " – " << r.p95_s * 1e3 << "</td>"
+          << "<td>" << fixed << setprecision(3) << speedupDe(r) << "</td>"
+          << "<td>" << fixed << setprecision(3) << eficienciaDe(r) << "</td>"
+          << "<td>" << fixed << setprecision(4) << r.analisis_s * 1e3 << "</td></tr>\n";
     }
     h << "</table></div>\n";
+    if (CONTADORES) {
+        // Totales por fase (sumados entre hilos) de la corrida instrumentada
+        auto celda = [](const LecturaHw& l, int e) {
+            return l.disponible[e] ? to_string(l.valor[e]) : string("n/d");
+        };
+        h << "<div class='card'><h2>Contadores de hardware por fase</h2>\n";
+        h << "<p>Disponibles en esta máquina: " << html_escape(ContadoresHw::diagnostico())
+          << ". Los tiempos suman todos los hilos e incluyen la espera en barreras. "
+             "Detalle por hilo en <b>" << html_escape(CSV_CONTADORES) << "</b>.</p>\n";
+        h << "<table><tr><th>Clientes</th><th>Modo</th><th>Hilos</th><th>Fase</th><th>Tiempo (ms)</th>"
+             "<th>Ciclos</th><th>Instrucciones</th><th>IPC</th><th>Fallos LLC</th><th>Cambios de contexto</th></tr>\n";
+        for (auto& r : resultados) {
+            for (int fase = 0; fase < NUM_FASES; fase++) {
+                LecturaHw l = r.perfil.totalFase(fase);
+                if (l.nanosegundos == 0) continue;
+                ostringstream ipc;
+                if (l.disponible[HW_CICLOS] && l.disponible[HW_INSTRUCCIONES] && l.valor[HW_CICLOS] > 0)
+                    ipc << fixed << setprecision(2) << (double)l.valor[HW_INSTRUCCIONES] / l.valor[HW_CICLOS];
+                else
+                    ipc << "n/d";
+                h << "<tr><td>" << r.clientes << "</td><td>" << r.modo << "</td><td>" << r.hilos << "</td>"
+                  << "<td>" << nombreFase(fase) << "</td>"
+                  << "<td>" << fixed << setprecision(3) << l.nanosegundos / 1e6 << "</td>"
+                  << "<td>" << celda(l, HW_CICLOS) << "</td><td>" << celda(l, HW_INSTRUCCIONES) << "</td>"
+                  << "<td>" << ipc.str() << "</td><td>" << celda(l, HW_FALLOS_LLC) << "</td>"
+                  << "<td>" << celda(l, HW_CAMBIOS_CONTEXTO) << "</td></tr>\n";
+            }
+        }
+        h << "</table></div>\n";
+    }
+    if (CONTENCION) {
+        // Filas: configuraciones en modo mutex. Columnas: los productos con más
+        // espera sumando todas las filas. El color es la parte de la espera de
+        // la fila que se fue en ese producto.
+        const int COLUMNAS = 20;
+        vector<const Resultado*> filas;
+        map<int, double> esperaTotal;
+        for (auto& r : resultados) {
+            if (r.locks.productos.empty()) continue;
+            filas.push_back(&r);
+            for (size_t p = 0; p < r.locks.productos.size(); p++)
+                if (r.locks.productos[p].contendidas > 0) esperaTotal[(int)p] += r.locks.esperaNs(r.locks.productos[p]);
+        }
+        vector<int> columnas;
+        for (auto& kv : esperaTotal) columnas.push_back(kv.first);
+        sort(columnas.begin(), columnas.end(), [&](int a, int b) {
+            return esperaTotal[a] != esperaTotal[b] ? esperaTotal[a] > esperaTotal[b] : a < b;
+        });
+        if ((int)columnas.size() > COLUMNAS) columnas.resize(COLUMNAS);
+
+        h << "<div class='card'><h2>Contención de locks por producto</h2>\n";
+        h << "<p>Corrida aparte (sin cronometrar) en modo mutex con cada lock instrumentado: try_lock primero y "
+             "rdtsc solo si el lock estaba tomado. Columnas: los " << COLUMNAS << " productos con más espera "
+             "sumando todas las configuraciones. El color es la fracción de la espera de la fila en ese producto "
+             "y la cifra, las tomas contendidas; el detalle está en el título de cada celda y en <b>"
+          << html_escape(CSV_LOCKS) << "</b>.</p>\n";
+        if (columnas.empty()) {
+            h << "<p>Ninguna toma encontró el lock tomado.</p>\n";
+        } else {
+            h << "<table class='calor'><tr><th>Clientes</th><th>Hilos</th><th>Modo</th><th>Tomas</th>"
+                 "<th>Contendidas</th><th>Espera (ms)</th><th>p99 (µs)</th>";
+            for (int p : columnas) h << "<th class='sku'>" << html_escape(NOMBRES_PRODUCTOS[p]) << "</th>";
+            h << "</tr>\n";
+            for (const Resultado* r : filas) {
+                const PerfilLocks& pl = r->locks;
+                ContencionProducto t = pl.total();
+                double espera = pl.esperaNs(t);
+                h << "<tr><td>" << r->clientes << "</td><td>" << r->hilos << "</td><td>" << r->modo << "</td>"
+                  << "<td>" << t.adquisiciones << "</td><td>" << t.contendidas << "</td>"
+                  << "<td>" << fixed << setprecision(3) << espera / 1e6 << "</td>"
+                  << "<td>" << setprecision(1) << pl.percentilNs(t, 99) / 1e3 << "</td>";
+                for (int p : columnas) {
+                    const ContencionProducto& c = pl.productos[p];
+                    double parte = espera > 0 ? pl.esperaNs(c) / espera : 0.0;
+                    h << "<td style='background:rgba(214,39,40," << setprecision(3) << parte << ")' title='"
+                      << html_escape(NOMBRES_PRODUCTOS[p]) << ": " << c.adquisiciones << " tomas, "
+                      << c.contendidas << " contendidas, " << setprecision(3) << pl.esperaNs(c) / 1e6
+                      << " ms de espera (" << setprecision(1) << parte * 100 << "%), p50 "
+                      << pl.percentilNs(c, 50) / 1e3 << " µs, p99 " << pl.percentilNs(c, 99) / 1e3 << " µs'>"
+                      << (c.contendidas > 0 ? to_string(c.contendidas) : string()) << "</td>";
+                }
+                h << "</tr>\n";
+            }
+            h << "</table>\n";
+        }
+        h << "</div>\n";
+    }
+    {
+        // Dónde corrieron los hilos de la última repetición de cada configuración
+        h << "<div class='card'><h2>Reparto por nodo NUMA</h2>\n";
+        h << "<p>Nodos en esta máquina: " << topologiaNuma().numNodos() << ". Afinidad: "
+          << (afinidadDelRuntime() ? "del runtime (OMP_PROC_BIND / OMP_PLACES)" : nombreAfinidad(AFINIDAD))
+          << ". Los tiempos suman los hilos de cada nodo. Datos en <b>" << html_escape(CSV_NODOS) << "</b>.</p>\n";
+        h << "<table><tr><th>Clientes</th><th>Modo</th><th>Hilos</th><th>Nodo</th><th>Hilos en el nodo</th>"
+             "<th>Lotes</th><th>Ocupado (ms)</th><th>Ocioso (ms)</th></tr>\n";
+        for (auto& r : resultados) {
+            for (const auto& rn : r.nodos) {
+                h << "<tr><td>" << r.clientes << "</td><td>" << r.modo << "</td><td>" << r.hilos << "</td>"
+                  << "<td>" << rn.nodo << "</td><td>" << rn.hilos << "</td><td>" << rn.tareas << "</td>"
+                  << "<td>" << fixed << setprecision(3) << rn.ocupado * 1e3 << "</td>"
+                  << "<td>" << rn.ocioso * 1e3 << "</td></tr>\n";
+            }
+        }
+        h << "</table></div>\n";
+    }
     for (auto& kv : porN) {
         int n = kv.first;
         auto filas = kv.second;
@@ -275,28 +539,34 @@ int main()
         int left = 180, right = 20, top = 20, barH = 24, gap = 6;
         h << "<svg width='"<<W<<"' height='"<<H<<"' viewBox='0 0 "<<W<<" "<<H<<"'>\n";
         h << "<line x1='"<<left<<"' y1='"<<H-top<<"' x2='"<<(W-right)<<"' y2='"<<H-top<<"' stroke='#999'/>\n";
+        int escala = W - left - right - 90;   // deja lugar para la etiqueta del valor
         int i = 0;
         for (auto& r : filas) {
-            double frac = (tmax>0? (r.tiempo_s / tmax) : 0.0);
-            int barW = (int)((W-left-right)*frac);
+            auto xDe = [&](double t) { return left + (int)(escala * (tmax > 0 ? t / tmax : 0.0)); };
+            int barW = xDe(r.tiempo_s) - left;
             int y = top + i*(barH+gap);
             ostringstream lbl;
             lbl << r.modo;
-            if (r.modo == "par") lbl << " ("<< r.hilos <<"h)";
+            if (r.modo != "sec" && r.modo != "sec_puro") lbl << " ("<< r.hilos <<"h)";
             if (r.modo == "sec_puro") lbl << " (*)";
             h << "<text x='"<< (left-10) <<"' y='"<< (y+barH-6) <<"' text-anchor='end' font-size='12'>"
               << lbl.str() << "</text>\n";
             h << "<rect x='"<<left<<"' y='"<<y<<"' width='"<<barW<<"' height='"<<barH<<"' fill='#4e79a7'/>\n";
+            // Intervalo de confianza de la mediana
+            int yc = y + barH / 2;
+            h << "<line x1='"<< xDe(r.ic95_inf_s) <<"' y1='"<< yc <<"' x2='"<< xDe(r.ic95_sup_s)
+              <<"' y2='"<< yc <<"' stroke='#222' stroke-width='2'/>\n";
             ostringstream val;
-            val << fixed << setprecision(3) << r.tiempo_s << " s";
-            h << "<text x='"<< (left+barW+6) <<"' y='"<< (y+barH-6) <<"' font-size='12'>"<< val.str() <<"</text>\n";
+            val << fixed << setprecision(3) << r.tiempo_s * 1e3 << " ms";
+            h << "<text x='"<< (xDe(r.ic95_sup_s)+6) <<"' y='"<< (y+barH-6) <<"' font-size='12'>"<< val.str() <<"</text>\n";
             ++i;
         }
-        h << "<text x='"<< ((left+W-right)/2) <<"' y='"<< (H-4) <<"' text-anchor='middle' font-size='12' fill='#555'>Tiempo (s) — escalado al máximo observado</text>\n";
+        h << "<text x='"<< ((left+W-right)/2) <<"' y='"<< (H-4) <<"' text-anchor='middle' font-size='12' fill='#555'>"
+             "Mediana (barra) e IC 95% (línea) — escalado al máximo observado</text>\n";
         h << "</svg></div>\n";
     }
-    h << "<p style='color:#666;font-size:13px'>(*) “sec_puro” corresponde al binario secuencial independiente si se configuró ruta. "
-         "Las comparaciones de speedup usan como base el modo “sec” del ejecutable unificado para consistencia.</p>\n";
+    h << "<p style='color:#666;font-size:13px'>(*) “sec_puro” usa el mismo kernel de cliente que “sec”, con mt19937, la cabecera sorteada cliente por cliente y stock ilimitado. "
+         "Las comparaciones de speedup usan como base el modo “sec” del simulador unificado para consistencia.</p>\n";
     h.close();
     cout << "HTML generado: " << HTML_SALIDA << endl;
     cout << "\nListo. Abre " << HTML_SALIDA << " para ver las gráficas.\n";
@@ -0,0 +1,152 @@
+#pragma once
+
+#include <cstdint>
+
+#if defined(__GNUC__) && defined(__x86_64__)
+#define PHILOX_X86 1
+#include <immintrin.h>
+#endif
+
+// Generador aleatorio basado en contador Philox4x32-10 (Salmon et al.,
+// "Parallel Random Numbers: As Easy as 1, 2, 3", SC'11).
+//
+// No guarda estado: cada bloque de 4 palabras de 32 bits es una función pura
+// de (contador, clave). Así cada cliente tiene su propio flujo derivado de
+// (semilla global, id de cliente) y el resultado no depende del hilo que lo
+// procese ni del orden en que se procesen los clientes.
+
+namespace philox {
+
+constexpr uint32_t MULT0  = 0xD2511F53u;
+constexpr uint32_t MULT1  = 0xCD9E8D57u;
+constexpr uint32_t WEYL0  = 0x9E3779B9u;
+constexpr uint32_t WEYL1  = 0xBB67AE85u;
+constexpr int      RONDAS = 10;
+
+struct Bloque {
+    uint32_t v[4];
+};
+
+inline Bloque generar(uint32_t c0, uint32_t c1, uint32_t c2, uint32_t c3,
+                      uint32_t k0, uint32_t k1) {
+    for (int r = 0; r < RONDAS; r++) {
+        uint64_t p0 = (uint64_t)MULT0 * c0;
+        uint64_t p1 = (uint64_t)MULT1 * c2;
+        uint32_t n0 = (uint32_t)(p1 >> 32) ^ c1 ^ k0;
+        uint32_t n2 = (uint32_t)(p0 >> 32) ^ c3 ^ k1;
+        c1 = (uint32_t)p1;
+        c3 = (uint32_t)p0;
+        c0 = n0;
+        c2 = n2;
+        k0 += WEYL0;
+        k1 += WEYL1;
+    }
+    return Bloque{{c0, c1, c2, c3}};
+}
+
+// Conversiones de una palabra de 32 bits a las distribuciones que usa el
+// simulador. Son exactas y baratas (sin rechazo), y las versiones SIMD
+// reproducen exactamente el mismo resultado.
+inline double uniforme01(uint32_t x) {
+    return x * (1.0 / 4294967296.0);
+}
+
+// Entero uniforme en [a, b] (multiplicación de Lemire, sesgo < 2^-32 por valor)
+inline int enteroEnRango(uint32_t x, int a, int b) {
+    return a + (int)(((uint64_t)x * (uint32_t)(b - a + 1)) >> 32);
+}
+
+inline double realEnRango(uint32_t x, double a, double b) {
+    return a + (b - a) * uniforme01(x);
+}
+
+// Flujo secuencial sobre los bloques de un (semilla, id, dominio). El
+// contador es {bloque, id, dominio, 0} y la clave son las dos mitades de la
+// semilla, así que flujos con distinto id o dominio nunca se solapan.
+class Flujo {
+public:
+    Flujo(uint64_t semilla, uint32_t id, uint32_t dominio, uint32_t bloqueInicial = 0)
+        : k0((uint32_t)semilla), k1((uint32_t)(semilla >> 32)),
+          id(id), dominio(dominio), siguienteBloque(bloqueInicial), pos(4) {}
+
+    uint32_t siguiente() {
+        if (pos == 4) {
+            buf = bloque(siguienteBloque++);
+            pos = 0;
+        }
+        return buf.v[pos++];
+    }
+
+    Bloque bloque(uint32_t n) const {
+        return generar(n, id, dominio, 0, k0, k1);
+    }
+
+private:
+    uint32_t k0, k1;
+    uint32_t id, dominio;
+    uint32_t siguienteBloque;
+    int pos;
+    Bloque buf;
+};
+
+#ifdef PHILOX_X86
+// Versiones vectoriales: cada carril de 32 bits es un flujo independiente con
+// su propio contador y todos comparten la clave. Dan exactamente los mismos
+// bloques que generar() carril por carril. El producto 32x32->64 se hace en
+// dos pasadas (carriles pares e impares) porque mul_epu32 solo usa la mitad
+// baja de cada palabra de 64 bits.
+
+__attribute__((target("avx2")))
+inline void mulhiloX8(__m256i a, __m256i m, __m256i& hi, __m256i& lo) {
+    __m256i pares   = _mm256_mul_epu32(a, m);
+    __m256i impares = _mm256_mul_epu32(_mm256_srli_epi64(a, 32), m);
+    hi = _mm256_blend_epi32(_mm256_srli_epi64(pares, 32), impares, 0xAA);
+    lo = _mm256_blend_epi32(pares, _mm256_slli_epi64(impares, 32), 0xAA);
+}
+
+__attribute__((target("avx2")))
+inline void generarX8(__m256i& c0, __m256i& c1, __m256i& c2, __m256i& c3,
+                      uint32_t k0, uint32_t k1) {
+    const __m256i m0 = _mm256_set1_epi64x(MULT0);
+    const __m256i m1 = _mm256_set1_epi64x(MULT1);
+    for (int r = 0; r < RONDAS; r++) {
+        __m256i hi0, lo0, hi1, lo1;
+        mulhiloX8(c0, m0, hi0, lo0);
+        mulhiloX8(c2, m1, hi1, lo1);
+        c0 = _mm256_xor_si256(_mm256_xor_si256(hi1, c1), _mm256_set1_epi32((int)k0));
+        c2 = _mm256_xor_si256(_mm256_xor_si256(hi0, c3), _mm256_set1_epi32((int)k1));
+        c1 = lo1;
+        c3 = lo0;
+        k0 += WEYL0;
+        k1 += WEYL1;
+    }
+}
+
+__attribute__((target("avx512f")))
+inline void mulhiloX16(__m512i a, __m512i m, __m512i& hi, __m512i& lo) {
+    __m512i pares   = _mm512_mul_epu32(a, m);
+    __m512i impares = _mm512_mul_epu32(_mm512_srli_epi64(a, 32), m);
+    hi = _mm512_mask_blend_epi32(0xAAAA, _mm512_srli_epi64(pares, 32), impares);
+    lo = _mm512_mask_blend_epi32(0xAAAA, pares, _mm512_slli_epi64(impares, 32));
+}
+
+__attribute__((target("avx512f")))
+inline void generarX16(__m512i& c0, __m512i& c1, __m512i& c2, __m512i& c3,
+                       uint32_t k0, uint32_t k1) {
+    const __m512i m0 = _mm512_set1_epi64(MULT0);
+    const __m512i m1 = _mm512_set1_epi64(MULT1);
+    for (int r = 0; r < RONDAS; r++) {
+        __m512i hi0, lo0, hi1, lo1;
+        mulhiloX16(c0, m0, hi0, lo0);
+        mulhiloX16(c2, m1, hi1, lo1);
+        c0 = _mm512_xor_si512(_mm512_xor_si512(hi1, c1), _mm512_set1_epi32((int)k0));
+        c2 = _mm512_xor_si512(_mm512_xor_si512(hi0, c3), _mm512_set1_epi32((int)k1));
+        c1 = lo1;
+        c3 = lo0;
+        k0 += WEYL0;
+        k1 += WEYL1;
+    }
+}
+#endif
+
+} // namespace philox
@@ -0,0 +1,112 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <vector>
+#include <omp.h>
+
+#include "linea_cache.hpp"
+
+// Reparto de tareas independientes entre hilos por robo de trabajo. Cada
+// hilo empieza con un tramo contiguo de tareas en su propia cola; las toma
+// desde el final y, cuando se le acaba, le roba a otro hilo desde el frente
+// (las tareas más lejanas de lo que el dueño está haciendo). Las tareas no
+// crean tareas nuevas, así que cuando un hilo encuentra todas las colas
+// vacías ya no queda nada por repartir.
+//
+// Las colas usan un mutex cada una: las tareas son gruesas (miles de
+// clientes), así que el costo del lock no se nota y el código queda simple.
+
+struct alignas(TAM_LINEA_CACHE) ColaRobo {
+    std::mutex m;
+    std::deque<int> tareas;
+
+    bool tomarPropia(int& t) {
+        std::lock_guard<std::mutex> g(m);
+        if (tareas.empty()) return false;
+        t = tareas.back();
+        tareas.pop_back();
+        return true;
+    }
+
+    bool robar(int& t) {
+        std::lock_guard<std::mutex> g(m);
+        if (tareas.empty()) return false;
+        t = tareas.front();
+        tareas.pop_front();
+        return true;
+    }
+};
+
+// Lo que hizo cada hilo durante el reparto. Cada hilo escribe la suya
+// después de cada tarea, así que van en líneas de caché separadas.
+struct alignas(TAM_LINEA_CACHE) EstadisticasHilo {
+    long long tareas = 0;
+    long long robos = 0;
+    double ocupado = 0;     // segundos dentro de las tareas
+    double ocioso = 0;      // segundos en la región sin tarea (buscando o esperando)
+    int cpu = -1;           // dónde corría al empezar (-1 = no se sabe)
+    int nodo = -1;
+};
+
+// Reparto con robo pensado para usarse dentro de una región paralela ya
+// abierta: un hilo llama a preparar() (o se llama antes de la región) y
+// después cada hilo pide tareas con siguiente() hasta que devuelva false.
+class RepartoRobo {
+public:
+    void preparar(int numTareas, int numHilos) {
+        colas = std::vector<ColaRobo>(numHilos);
+        for (int h = 0; h < numHilos; h++) {
+            int desde = (int)((long long)numTareas * h / numHilos);
+            int hasta = (int)((long long)numTareas * (h + 1) / numHilos);
+            for (int t = desde; t < hasta; t++) colas[h].tareas.push_back(t);
+        }
+    }
+
+    bool siguiente(int yo, int& t, EstadisticasHilo& st) {
+        // se roba de todas las colas aunque el runtime haya dado menos hilos
+        int hilos = (int)colas.size();
+        if (colas[yo].tomarPropia(t)) return true;
+        for (int d = 1; d < hilos; d++) {
+            if (colas[(yo + d) % hilos].robar(t)) {
+                st.robos++;
+                return true;
+            }
+        }
+        return false;
+    }
+
+private:
+    std::vector<ColaRobo> colas;
+};
+
+// Ejecuta tarea(t, hilo) para t en [0, numTareas) con robo de trabajo.
+// Devuelve las estadísticas por hilo.
+template <class Tarea>
+std::vector<EstadisticasHilo> ejecutarConRobo(int numTareas, int numHilos, Tarea tarea) {
+    if (numHilos <= 0) numHilos = omp_get_max_threads();
+    RepartoRobo reparto;
+    reparto.preparar(numTareas, numHilos);
+    std::vector<EstadisticasHilo> stats(numHilos);
+
+    #pragma omp parallel num_threads(numHilos)
+    {
+        using reloj = std::chrono::steady_clock;
+        int yo = omp_get_thread_num();
+        EstadisticasHilo& st = stats[yo];
+        auto inicio = reloj::now();
+        int t;
+        while (reparto.siguiente(yo, t, st)) {
+            auto t0 = reloj::now();
+            tarea(t, yo);
+            st.ocupado += std::chrono::duration<double>(reloj::now() - t0).count();
+            st.tareas++;
+        }
+        // Espera a que terminen los demás para contar el tiempo ocioso completo
+        #pragma omp barrier
+        st.ocioso = std::chrono::duration<double>(reloj::now() - inicio).count() - st.ocupado;
+    }
+    return stats;
+}
@@ -0,0 +1,420 @@
+#pragma once
+
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <unistd.h>
+#define REGISTRO_POSIX 1
+#endif
+
+#include "linea_cache.hpp"
+
+// Registro binario de todas las transacciones (cada cliente con sus líneas),
+// por columnas y comprimido, escrito mientras se simula.
+//
+// Cada hilo codifica sus clientes en bloques (uno por lote de clientes) dentro
+// de su propio buffer. Cuando el buffer se llena se le pasa al hilo escritor
+// y el hilo sigue en su segundo buffer (doble buffer por hilo); solo espera
+// si el escritor todavía no devolvió el otro. El escritor hace write() de
+// buffers enteros, sin iostream, en paralelo con la simulación.
+//
+// Archivo: CabeceraRegistro y después bloques en cualquier orden de hilos.
+// Cada bloque trae el id de su primer cliente, así que se pueden reordenar.
+// Las columnas de un bloque usan varint (7 bits por byte) y, donde ayuda,
+// diferencias con zigzag:
+//
+//   id              diferencia con el cliente anterior del bloque (zigzag)
+//   tipoPago        tipo * 2 + tarjeta (un byte)
+//   numLineas       varint
+//   totalCentavos   varint
+//   compraMs        tiempo de compra en milisegundos, varint
+//   pagoMs          tiempo en la caja en milisegundos, varint
+//   producto        id de producto de cada línea, varint
+//   cantidad        cantidad de cada línea, varint
+
+constexpr char MAGIA_REGISTRO[8] = {'S', 'U', 'P', 'T', 'R', 'X', '0', '1'};
+constexpr uint32_t MAGIA_BLOQUE = 0x45544F4C;   // "LOTE"
+constexpr uint32_t VERSION_REGISTRO = 1;
+
+enum ColumnaRegistro {
+    COL_ID,
+    COL_TIPO_PAGO,
+    COL_NUM_LINEAS,
+    COL_TOTAL_CENTAVOS,
+    COL_COMPRA_MS,
+    COL_PAGO_MS,
+    COL_PRODUCTO,
+    COL_CANTIDAD,
+    NUM_COLUMNAS_REGISTRO
+};
+
+struct CabeceraRegistro {
+    char magia[8];
+    uint32_t version;
+    uint32_t numColumnas;
+    uint64_t semilla;
+};
+
+struct CabeceraBloque {
+    uint32_t magia;
+    uint32_t bytes;           // columnas, sin contar esta cabecera
+    uint32_t numClientes;
+    uint32_t numLineas;
+    int32_t primerId;
+    uint32_t hilo;
+    uint32_t bytesColumna[NUM_COLUMNAS_REGISTRO];
+};
+
+inline void escribirVarint(std::vector<uint8_t>& v, uint64_t x) {
+    while (x >= 0x80) {
+        v.push_back((uint8_t)(x | 0x80));
+        x >>= 7;
+    }
+    v.push_back((uint8_t)x);
+}
+
+inline uint64_t zigzag(int64_t x) { return ((uint64_t)x << 1) ^ (uint64_t)(x >> 63); }
+inline int64_t deshacerZigzag(uint64_t x) { return (int64_t)(x >> 1) ^ -(int64_t)(x & 1); }
+
+// Lee un varint; devuelve false si se acaba el bloque
+inline bool leerVarint(const uint8_t*& p, const uint8_t* fin, uint64_t& x) {
+    x = 0;
+    for (int desp = 0; p < fin && desp < 64; desp += 7) {
+        uint8_t b = *p++;
+        x |= (uint64_t)(b & 0x7F) << desp;
+        if (!(b & 0x80)) return true;
+    }
+    return false;
+}
+
+class RegistroTransacciones {
+public:
+    explicit RegistroTransacciones(const std::string& ruta, uint64_t semilla = 0,
+                                   size_t tamBuffer = 1 << 20)
+        : ruta(ruta), tamBuffer(tamBuffer) {
+#ifdef REGISTRO_POSIX
+        fd = ::open(ruta.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (fd < 0) throw std::runtime_error("no se pudo crear " + ruta);
+#else
+        archivo = std::fopen(ruta.c_str(), "wb");
+        if (!archivo) throw std::runtime_error("no se pudo crear " + ruta);
+#endif
+        CabeceraRegistro cab;
+        std::memset(&cab, 0, sizeof(cab));
+        std::memcpy(cab.magia, MAGIA_REGISTRO, sizeof(MAGIA_REGISTRO));
+        cab.version = VERSION_REGISTRO;
+        cab.numColumnas = NUM_COLUMNAS_REGISTRO;
+        cab.semilla = semilla;
+        escribirTodo(&cab, sizeof(cab));
+        escritor = std::thread([this] { bucleEscritor(); });
+    }
+
+    ~RegistroTransacciones() {
+        try { cerrar(); } catch (...) {}
+    }
+
+    RegistroTransacciones(const RegistroTransacciones&) = delete;
+    RegistroTransacciones& operator=(const RegistroTransacciones&) = delete;
+
+    // Se llama antes de cada región paralela, fuera de ella
+    void preparar(int numHilos) {
+        while ((int)hilos.size() < numHilos) hilos.emplace_back(new EstadoHilo(tamBuffer));
+    }
+
+    // Agrega un cliente al bloque en curso del hilo. Cliente es el del
+    // simulador: se leen id, tipo, metodoPago, total, tiempos y el carrito.
+    template <class ClienteT>
+    void agregar(int hilo, const ClienteT& c) {
+        EstadoHilo& h = *hilos[hilo];
+        if (h.numClientes == 0) {
+            h.primerId = c.id;
+            h.idAnterior = c.id;
+        }
+        auto& col = h.columnas;
+        escribirVarint(col[COL_ID], zigzag((int64_t)c.id - h.idAnterior));
+        h.idAnterior = c.id;
+        col[COL_TIPO_PAGO].push_back((uint8_t)(c.tipo * 2 + ((int)c.metodoPago != 0)));
+        escribirVarint(col[COL_NUM_LINEAS], c.numLineas);
+        escribirVarint(col[COL_TOTAL_CENTAVOS], (uint64_t)std::llround(c.total * 100));
+        escribirVarint(col[COL_COMPRA_MS], (uint64_t)std::llround(c.tiempoCompra * 1000));
+        escribirVarint(col[COL_PAGO_MS], (uint64_t)std::llround(c.tiempoPago * 1000));
+        for (int j = 0; j < c.numLineas; j++) {
+            escribirVarint(col[COL_PRODUCTO], c.carrito[j].producto);
+            escribirVarint(col[COL_CANTIDAD], c.carrito[j].cantidad);
+        }
+        h.numClientes++;
+        h.numLineas += c.numLineas;
+    }
+
+    // Cierra el bloque en curso del hilo y lo copia a su buffer
+    void cerrarBloque(int hilo) {
+        EstadoHilo& h = *hilos[hilo];
+        if (h.numClientes == 0) return;
+        CabeceraBloque cab;
+        std::memset(&cab, 0, sizeof(cab));
+        cab.magia = MAGIA_BLOQUE;
+        cab.numClientes = h.numClientes;
+        cab.numLineas = h.numLineas;
+        cab.primerId = h.primerId;
+        cab.hilo = (uint32_t)hilo;
+        for (int k = 0; k < NUM_COLUMNAS_REGISTRO; k++) {
+            cab.bytesColumna[k] = (uint32_t)h.columnas[k].size();
+            cab.bytes += cab.bytesColumna[k];
+        }
+
+        size_t total = sizeof(cab) + cab.bytes;
+        if (h.activo->usados + total > h.activo->datos.size()) {
+            entregar(h);
+            if (total > h.activo->datos.size()) h.activo->datos.resize(total);
+        }
+        Buffer& b = *h.activo;
+        std::memcpy(b.datos.data() + b.usados, &cab, sizeof(cab));
+        b.usados += sizeof(cab);
+        for (auto& col : h.columnas) {
+            std::memcpy(b.datos.data() + b.usados, col.data(), col.size());
+            b.usados += col.size();
+            col.clear();
+        }
+        h.bloques++;
+        h.clientes += h.numClientes;
+        h.lineas += h.numLineas;
+        h.numClientes = h.numLineas = 0;
+    }
+
+    // Entrega lo que quede en los buffers y espera a que todo esté escrito.
+    // Llamar fuera de las regiones paralelas. Lanza si falló alguna escritura.
+    void cerrar() {
+        if (cerrado) return;
+        for (int t = 0; t < (int)hilos.size(); t++) {
+            cerrarBloque(t);
+            if (hilos[t]->activo->usados > 0) entregar(*hilos[t]);
+        }
+        {
+            std::lock_guard<std::mutex> g(m);
+            terminar = true;
+        }
+        hayTrabajo.notify_one();
+        if (escritor.joinable()) escritor.join();
+#ifdef REGISTRO_POSIX
+        if (fd >= 0 && ::close(fd) != 0) error = true;
+        fd = -1;
+#else
+        if (archivo && std::fclose(archivo) != 0) error = true;
+        archivo = nullptr;
+#endif
+        cerrado = true;
+        if (error) throw std::runtime_error("error al escribir " + ruta);
+    }
+
+    uint64_t bytesEscritos() const { return escritos.load(); }
+
+    long long bloques() const { return sumar(&EstadoHilo::bloques); }
+    long long clientes() const { return sumar(&EstadoHilo::clientes); }
+    long long lineas() const { return sumar(&EstadoHilo::lineas); }
+
+    // Segundos que los hilos de simulación esperaron a que el escritor les
+    // devolviera un buffer (0 = la escritura no frenó la simulación)
+    double segundosEspera() const {
+        double s = 0;
+        for (const auto& h : hilos) s += h->espera;
+        return s;
+    }
+
+private:
+    struct Buffer {
+        std::vector<uint8_t> datos;
+        size_t usados = 0;
+        bool libre = true;    // protegido por 'm'
+    };
+
+    struct alignas(TAM_LINEA_CACHE) EstadoHilo {
+        Buffer buffers[2];
+        Buffer* activo;
+        std::vector<uint8_t> columnas[NUM_COLUMNAS_REGISTRO];
+        int primerId = 0;
+        int64_t idAnterior = 0;
+        uint32_t numClientes = 0;
+        uint32_t numLineas = 0;
+        long long bloques = 0, clientes = 0, lineas = 0;
+        double espera = 0;
+
+        explicit EstadoHilo(size_t tam) {
+            buffers[0].datos.resize(tam);
+            buffers[1].datos.resize(tam);
+            activo = &buffers[0];
+        }
+    };
+
+    long long sumar(long long EstadoHilo::*campo) const {
+        long long s = 0;
+        for (const auto& h : hilos) s += (*h).*campo;
+        return s;
+    }
+
+    // Pasa el buffer activo al escritor y sigue con el otro (esperando si
+    // todavía se está escribiendo)
+    void entregar(EstadoHilo& h) {
+        Buffer* lleno = h.activo;
+        Buffer* otro = (lleno == &h.buffers[0]) ? &h.buffers[1] : &h.buffers[0];
+        std::unique_lock<std::mutex> g(m);
+        lleno->libre = false;
+        cola.push_back(lleno);
+        hayTrabajo.notify_one();
+        if (!otro->libre) {
+            auto t0 = std::chrono::steady_clock::now();
+            bufferLibre.wait(g, [&] { return otro->libre; });
+            h.espera += std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+        }
+        h.activo = otro;
+    }
+
+    void bucleEscritor() {
+        std::unique_lock<std::mutex> g(m);
+        for (;;) {
+            hayTrabajo.wait(g, [&] { return terminar || !cola.empty(); });
+            if (cola.empty()) return;
+            Buffer* b = cola.front();
+            cola.pop_front();
+            g.unlock();
+            escribirTodo(b->datos.data(), b->usados);
+            g.lock();
+            b->usados = 0;
+            b->libre = true;
+            bufferLibre.notify_all();
+        }
+    }
+
+    void escribirTodo(const void* datos, size_t bytes) {
+        const char* p = static_cast<const char*>(datos);
+        while (bytes > 0 && !error) {
+#ifdef REGISTRO_POSIX
+            ssize_t n = ::write(fd, p, bytes);
+            if (n < 0) {
+                if (errno == EINTR) continue;
+                error = true;
+                break;
+            }
+#else
+            size_t n = std::fwrite(p, 1, bytes, archivo);
+            if (n == 0) {
+                error = true;
+                break;
+            }
+#endif
+            p += n;
+            bytes -= (size_t)n;
+            escritos += (uint64_t)n;
+        }
+    }
+
+    std::string ruta;
+    size_t tamBuffer;
+#ifdef REGISTRO_POSIX
+    int fd = -1;
+#else
+    std::FILE* archivo = nullptr;
+#endif
+    std::vector<std::unique_ptr<EstadoHilo>> hilos;
+    std::mutex m;
+    std::condition_variable hayTrabajo, bufferLibre;
+    std::deque<Buffer*> cola;
+    bool terminar = false;
+    bool cerrado = false;
+    std::atomic<bool> error{false};
+    std::atomic<uint64_t> escritos{0};
+    std::thread escritor;
+};
+
+// Un cliente leído del registro
+struct TransaccionLeida {
+    int id;
+    int tipo;
+    bool tarjeta;
+    long long totalCentavos;
+    double tiempoCompra;
+    double tiempoPago;
+    std::vector<std::pair<uint32_t, uint32_t>> lineas;   // producto, cantidad
+};
+
+// Recorre el registro y llama a 'visitar' por cada cliente, en el orden en
+// que están en el archivo (por bloques, no por id). Lanza si está dañado.
+inline void leerRegistroTransacciones(const std::string& ruta,
+                                      const std::function<void(const TransaccionLeida&)>& visitar) {
+    std::FILE* f = std::fopen(ruta.c_str(), "rb");
+    if (!f) throw std::runtime_error("no se pudo abrir " + ruta);
+    std::unique_ptr<std::FILE, int (*)(std::FILE*)> cerrar(f, std::fclose);
+    auto error = [&](const std::string& que) {
+        return std::runtime_error(ruta + ": registro inválido (" + que + ")");
+    };
+    CabeceraRegistro cab;
+    if (std::fread(&cab, sizeof(cab), 1, f) != 1 || std::memcmp(cab.magia, MAGIA_REGISTRO, 8) != 0)
+        throw error("firma");
+    if (cab.version != VERSION_REGISTRO || cab.numColumnas != NUM_COLUMNAS_REGISTRO)
+        throw error("versión");
+
+    std::vector<uint8_t> datos;
+    CabeceraBloque bloque;
+    TransaccionLeida t;
+    for (;;) {
+        // Un archivo que termina a mitad de una cabecera está cortado, no completo
+        size_t leidos = std::fread(&bloque, 1, sizeof(bloque), f);
+        if (leidos == 0 && std::feof(f)) break;
+        if (leidos != sizeof(bloque)) throw error(std::ferror(f) ? "lectura" : "bloque cortado");
+        if (bloque.magia != MAGIA_BLOQUE) throw error("bloque");
+        datos.resize(bloque.bytes);
+        if (bloque.bytes > 0 && std::fread(datos.data(), bloque.bytes, 1, f) != 1) throw error("bloque cortado");
+        // Los tamaños de columna vienen del archivo: se validan antes de
+        // formar punteros dentro de 'datos'
+        uint64_t suma = 0;
+        for (int k = 0; k < NUM_COLUMNAS_REGISTRO; k++) suma += bloque.bytesColumna[k];
+        if (suma != bloque.bytes) throw error("columnas");
+        const uint8_t* col[NUM_COLUMNAS_REGISTRO];
+        const uint8_t* fin[NUM_COLUMNAS_REGISTRO];
+        size_t desp = 0;
+        for (int k = 0; k < NUM_COLUMNAS_REGISTRO; k++) {
+            col[k] = datos.data() + desp;
+            desp += bloque.bytesColumna[k];
+            fin[k] = datos.data() + desp;
+        }
+        auto leer = [&](int k) {
+            uint64_t x;
+            if (!leerVarint(col[k], fin[k], x)) throw error("columna " + std::to_string(k));
+            return x;
+        };
+        int64_t id = bloque.primerId;
+        for (uint32_t i = 0; i < bloque.numClientes; i++) {
+            id += deshacerZigzag(leer(COL_ID));
+            if (col[COL_TIPO_PAGO] >= fin[COL_TIPO_PAGO]) throw error("columna tipoPago");
+            uint8_t tp = *col[COL_TIPO_PAGO]++;
+            t.id = (int)id;
+            t.tipo = tp >> 1;
+            t.tarjeta = (tp & 1) != 0;
+            uint64_t numLineas = leer(COL_NUM_LINEAS);
+            t.totalCentavos = (long long)leer(COL_TOTAL_CENTAVOS);
+            t.tiempoCompra = leer(COL_COMPRA_MS) / 1000.0;
+            t.tiempoPago = leer(COL_PAGO_MS) / 1000.0;
+            t.lineas.clear();
+            for (uint64_t j = 0; j < numLineas; j++) {
+                uint32_t producto = (uint32_t)leer(COL_PRODUCTO);
+                t.lineas.push_back({producto, (uint32_t)leer(COL_CANTIDAD)});
+            }
+            visitar(t);
+        }
+    }
+}
@@ -0,0 +1,298 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+#include "philox.hpp"
+
+// Simulación de eventos discretos de las cajas. Cada cliente entra a la
+// tienda según un proceso de Poisson, recorre los pasillos durante su tiempo
+// de selección y se forma en la caja con menos gente (empates: la de menor
+// número). La atención dura el tiempo de pago, que ya trae el factor de
+// tarjeta, más un tiempo de escaneo por unidad comprada.
+//
+// El calendario es un heap 4-ario de eventos de 16 bytes: con cuatro hijos
+// por nodo el árbol tiene la mitad de niveles que uno binario y los hijos de
+// un nodo caen en la misma línea de caché. Las llegadas a la tienda se
+// agendan de a una (la siguiente recién cuando ocurre la actual), así el
+// heap solo guarda a los clientes que están comprando y un fin de atención
+// por caja.
+
+constexpr uint32_t DOMINIO_LLEGADAS = 2;   // flujo Philox de los intervalos entre llegadas
+
+struct ClienteCaja {
+    float tiempoSeleccion;   // segundos recorriendo la tienda
+    float tiempoServicio;    // segundos en la caja (pago + escaneo)
+};
+
+struct ConfigCajas {
+    int numCajas = 8;
+    double llegadasPorHora = 0;         // 0 = la que deja las cajas al 85%
+    double segundosPorProducto = 2.0;   // escaneo por unidad
+    uint64_t semilla = 0;
+};
+
+struct EstadisticasCaja {
+    long long atendidos = 0;
+    double tiempoOcupado = 0;
+    double utilizacion = 0;
+    double esperaMedia = 0;
+    int colaMaxima = 0;
+};
+
+struct ResultadoCajas {
+    std::vector<EstadisticasCaja> cajas;
+    double llegadasPorHora = 0;
+    double duracion = 0;                // segundos simulados hasta el último fin de atención
+    double esperaMedia = 0;
+    double esperaP50 = 0, esperaP90 = 0, esperaP95 = 0, esperaP99 = 0;
+    double esperaMaxima = 0;
+    long long eventos = 0;
+    double segundosCpu = 0;
+    double eventosPorSegundo = 0;
+};
+
+// Heap 4-ario de mínimos sobre un vector contiguo
+template <class T, class Menor>
+class Heap4 {
+public:
+    bool empty() const { return datos.empty(); }
+    size_t size() const { return datos.size(); }
+    const T& top() const { return datos.front(); }
+    void reserve(size_t n) { datos.reserve(n); }
+
+    void push(const T& x) {
+        size_t i = datos.size();
+        datos.push_back(x);
+        while (i > 0) {
+            size_t padre = (i - 1) / 4;
+            if (!menor(x, datos[padre])) break;
+            datos[i] = datos[padre];
+            i = padre;
+        }
+        datos[i] = x;
+    }
+
+    void pop() {
+        T x = datos.back();
+        datos.pop_back();
+        size_t n = datos.size();
+        if (n == 0) return;
+        size_t i = 0;
+        for (;;) {
+            size_t primero = 4 * i + 1;
+            if (primero >= n) break;
+            size_t ultimo = std::min(primero + 4, n);
+            size_t m = primero;
+            for (size_t c = primero + 1; c < ultimo; c++)
+                m = menor(datos[c], datos[m]) ? c : m;
+            if (!menor(datos[m], x)) break;
+            datos[i] = datos[m];
+            i = m;
+        }
+        datos[i] = x;
+    }
+
+private:
+    std::vector<T> datos;
+    Menor menor;
+};
+
+class SimulacionCajas {
+public:
+    explicit SimulacionCajas(const ConfigCajas& cfg) : cfg(cfg) {
+        if (cfg.numCajas < 1) throw std::invalid_argument("se necesita al menos una caja");
+    }
+
+    ResultadoCajas ejecutar(const std::vector<ClienteCaja>& clientes) {
+        auto inicio = std::chrono::steady_clock::now();
+        ResultadoCajas r;
+        int numCajas = cfg.numCajas;
+        uint32_t n = (uint32_t)clientes.size();
+        if (n >= MAX_INDICE) throw std::length_error("demasiados clientes para el calendario");
+
+        // Tasa de llegadas: la pedida o la que deja las cajas al 85% de uso
+        double lambda = cfg.llegadasPorHora / 3600.0;
+        if (lambda <= 0) {
+            double servicioMedio = 0;
+            for (const auto& c : clientes) servicioMedio += c.tiempoServicio;
+            servicioMedio = n ? servicioMedio / n : 1.0;
+            lambda = 0.85 * numCajas / servicioMedio;
+        }
+        r.llegadasPorHora = lambda * 3600.0;
+
+        // Los instantes de llegada no dependen de la simulación: se sortean en
+        // paralelo antes de empezar y el bucle de eventos solo los lee
+        std::vector<double> llegada(n);
+        #pragma omp parallel for schedule(static)
+        for (long long i = 0; i < (long long)n; i++) llegada[i] = intervaloLlegada((uint32_t)i, lambda);
+        for (uint32_t i = 1; i < n; i++) llegada[i] += llegada[i - 1];
+
+        // Estado de cada caja: cola FIFO (índices de cliente) y quién se atiende
+        std::vector<std::vector<uint32_t>> colas(numCajas);
+        std::vector<size_t> frente(numCajas, 0);
+        std::vector<uint32_t> enCaja(numCajas, LIBRE);
+        TorneoCajas torneo(numCajas);
+        std::vector<double> llegadaCaja(n);
+        r.cajas.assign(numCajas, EstadisticasCaja());
+        std::vector<double> esperaTotal(numCajas, 0.0);
+
+        std::vector<uint64_t> histograma(MAX_ESPERA_S + 1, 0);
+        double sumaEsperas = 0;
+
+        Heap4<Evento, MenorEvento> calendario;
+        calendario.reserve(1024);
+        uint32_t secuencia = 0;
+        auto agendar = [&](double t, uint32_t tipo, uint32_t indice) {
+            calendario.push(Evento{t, secuencia++, (tipo << 30) | indice});
+        };
+
+        double reloj = 0;
+        if (n > 0) agendar(llegada[0], LLEGADA_TIENDA, 0);
+
+        auto iniciarAtencion = [&](int caja, uint32_t cliente) {
+            double espera = reloj - llegadaCaja[cliente];
+            sumaEsperas += espera;
+            esperaTotal[caja] += espera;
+            histograma[std::min<long long>((long long)espera, MAX_ESPERA_S)]++;
+            r.esperaMaxima = std::max(r.esperaMaxima, espera);
+            enCaja[caja] = cliente;
+            r.cajas[caja].tiempoOcupado += clientes[cliente].tiempoServicio;
+            agendar(reloj + clientes[cliente].tiempoServicio, FIN_ATENCION, (uint32_t)caja);
+        };
+
+        while (!calendario.empty()) {
+            Evento e = calendario.top();
+            calendario.pop();
+            reloj = e.tiempo;
+            r.eventos++;
+            uint32_t tipo = e.dato >> 30, indice = e.dato & (MAX_INDICE - 1);
+
+            if (tipo == LLEGADA_TIENDA) {
+                agendar(reloj + clientes[indice].tiempoSeleccion, LLEGADA_CAJA, indice);
+                if (indice + 1 < n) agendar(llegada[indice + 1], LLEGADA_TIENDA, indice + 1);
+            } else if (tipo == LLEGADA_CAJA) {
+                llegadaCaja[indice] = reloj;
+                int mejor = torneo.mejor();
+                torneo.cambiar(mejor, +1);
+                if (enCaja[mejor] == LIBRE) {
+                    iniciarAtencion(mejor, indice);
+                } else {
+                    colas[mejor].push_back(indice);
+                    r.cajas[mejor].colaMaxima = std::max(r.cajas[mejor].colaMaxima,
+                                                         (int)(colas[mejor].size() - frente[mejor]));
+                }
+            } else {
+                int caja = (int)indice;
+                r.cajas[caja].atendidos++;
+                torneo.cambiar(caja, -1);
+                enCaja[caja] = LIBRE;
+                std::vector<uint32_t>& cola = colas[caja];
+                if (frente[caja] < cola.size()) {
+                    iniciarAtencion(caja, cola[frente[caja]++]);
+                    // Compactar de vez en cuando para que la cola no crezca sin límite
+                    if (frente[caja] == cola.size()) {
+                        cola.clear();
+                        frente[caja] = 0;
+                    } else if (frente[caja] >= 4096 && frente[caja] * 2 >= cola.size()) {
+                        cola.erase(cola.begin(), cola.begin() + frente[caja]);
+                        frente[caja] = 0;
+                    }
+                }
+            }
+        }
+
+        r.duracion = reloj;
+        for (int c = 0; c < numCajas; c++) {
+            EstadisticasCaja& ec = r.cajas[c];
+            ec.utilizacion = reloj > 0 ? ec.tiempoOcupado / reloj : 0.0;
+            ec.esperaMedia = ec.atendidos ? esperaTotal[c] / ec.atendidos : 0.0;
+        }
+        r.esperaMedia = n ? sumaEsperas / n : 0.0;
+        r.esperaP50 = percentilHistograma(histograma, n, 0.50);
+        r.esperaP90 = percentilHistograma(histograma, n, 0.90);
+        r.esperaP95 = percentilHistograma(histograma, n, 0.95);
+        r.esperaP99 = percentilHistograma(histograma, n, 0.99);
+
+        r.segundosCpu = std::chrono::duration<double>(std::chrono::steady_clock::now() - inicio).count();
+        r.eventosPorSegundo = r.segundosCpu > 0 ? r.eventos / r.segundosCpu : 0.0;
+        return r;
+    }
+
+private:
+    enum : uint32_t { LLEGADA_TIENDA = 0, LLEGADA_CAJA = 1, FIN_ATENCION = 2 };
+    static constexpr uint32_t MAX_INDICE = 1u << 30;
+    static constexpr uint32_t LIBRE = 0xFFFFFFFFu;
+    static constexpr long long MAX_ESPERA_S = 6 * 3600;   // el histograma agrupa lo que pase de 6 h
+
+    // Tipo en los 2 bits altos de 'dato', índice de cliente o de caja en el resto.
+    // A igual tiempo se respeta el orden en que se agendaron.
+    struct Evento {
+        double tiempo;
+        uint32_t secuencia;
+        uint32_t dato;
+    };
+    struct MenorEvento {
+        bool operator()(const Evento& a, const Evento& b) const {
+            // Sin cortocircuito: el compilador lo resuelve sin saltos
+            return (a.tiempo < b.tiempo) | ((a.tiempo == b.tiempo) & (a.secuencia < b.secuencia));
+        }
+    };
+
+    // Árbol de torneo sobre las cajas: la raíz es la caja con menos gente (en
+    // cola más el que se atiende; empates, la de menor número). Cada cambio
+    // recorre log2(cajas) nodos, en vez de revisar todas las cajas por cliente.
+    class TorneoCajas {
+    public:
+        explicit TorneoCajas(int numCajas) {
+            hojas = 1;
+            while (hojas < numCajas) hojas *= 2;
+            gente.assign(hojas, 0);
+            for (int c = numCajas; c < hojas; c++) gente[c] = LIBRE;   // hojas de relleno
+            nodo.resize(2 * hojas);
+            for (int c = 0; c < hojas; c++) nodo[hojas + c] = c;
+            for (int i = hojas - 1; i >= 1; i--) nodo[i] = ganador(nodo[2 * i], nodo[2 * i + 1]);
+        }
+
+        int mejor() const { return nodo[1]; }
+
+        void cambiar(int caja, int delta) {
+            gente[caja] += delta;
+            for (int i = (hojas + caja) / 2; i >= 1; i /= 2)
+                nodo[i] = ganador(nodo[2 * i], nodo[2 * i + 1]);
+        }
+
+    private:
+        int hojas;
+        std::vector<uint32_t> gente;
+        std::vector<int> nodo;
+
+        // a < b siempre (a está a la izquierda), así el empate queda en a
+        int ganador(int a, int b) const { return gente[b] < gente[a] ? b : a; }
+    };
+
+    ConfigCajas cfg;
+
+    // Intervalo exponencial antes de la llegada del cliente i; depende solo
+    // de (semilla, i), igual que el resto de los sorteos del simulador
+    double intervaloLlegada(uint32_t i, double lambda) const {
+        philox::Bloque b = philox::Flujo(cfg.semilla, i, DOMINIO_LLEGADAS).bloque(0);
+        double u = ((b.v[0] >> 5) * 67108864.0 + (b.v[1] >> 6)) * (1.0 / 9007199254740992.0);
+        return -std::log1p(-u) / lambda;
+    }
+
+    // Percentil con resolución de un segundo (redondeado hacia abajo)
+    static double percentilHistograma(const std::vector<uint64_t>& h, uint64_t total, double p) {
+        if (total == 0) return 0.0;
+        uint64_t objetivo = (uint64_t)std::ceil(p * total);
+        uint64_t acumulado = 0;
+        for (size_t s = 0; s < h.size(); s++) {
+            acumulado += h[s];
+            if (acumulado >= objetivo) return (double)s;
+        }
+        return (double)(h.size() - 1);
+    }
+};
@@ -0,0 +1,1782 @@
+#pragma once
+
+#include <iostream>
+#include <vector>
+#include <map>
+#include <unordered_map>
+#include <stdexcept>
+#include <string>
+#include <random>
+#include <chrono>
+#include <iomanip>
+#include <algorithm>
+#include <mutex>
+#include <omp.h>
+#include <memory>
+#include <cstdint>
+#include <cmath>
+#include <limits>
+#include <atomic>
+#include <new>
+#include "linea_cache.hpp"
+#include "philox.hpp"
+#include "lote_clientes.hpp"
+#include "configuracion.hpp"
+#include "contadores_hw.hpp"
+#include "simulacion_cajas.hpp"
+#include "planificador.hpp"
+#include "afinidad_numa.hpp"
+#include "catalogo_columnar.hpp"
+#include "registro_transacciones.hpp"
+#include "instantanea.hpp"
+#include "traza.hpp"
+#include "contencion_locks.hpp"
+
+using namespace std;
+using namespace std::chrono;
+
+constexpr double PRECIO_CARO = 5.00; // a partir de aquí un producto es "caro"
+constexpr int MAX_CATEGORIAS = 256;  // tamaño fijo de los acumuladores por categoría
+
+// Catálogo plano indexado por id de producto (struct-of-arrays).
+// Las columnas del camino caliente (precio, stock, vendidos, categoría) son
+// arreglos contiguos; los nombres quedan aparte y solo se usan al reportar.
+// Con un catálogo columnar las columnas apuntan al archivo mapeado (ver
+// catalogo_columnar.hpp); 'vendidos' siempre es propio.
+struct Catalogo {
+    Columna<double> precio;
+    Columna<int32_t> stock;
+    vector<int> vendidos;
+    Columna<uint16_t> categoria;      // id de categoría (ver nombresCategoria)
+
+    Columna<int32_t> precioCentavos;  // mismo precio en centavos, para sumar exacto
+
+    PoolTextos nombre;
+    vector<string> nombresCategoria;
+    unordered_map<string, uint16_t> idsCategoria;
+
+    // Índices de productos por clase de precio, para elegir un producto de la
+    // clase deseada con un solo sorteo
+    Columna<int32_t> indicesBaratos;
+    Columna<int32_t> indicesCaros;
+
+    // Solo si los productos tienen pesos de popularidad: tablas de alias
+    // sobre las posiciones de indicesBaratos / indicesCaros
+    TablaAlias aliasBaratos;
+    TablaAlias aliasCaros;
+
+    int size() const { return (int)precio.size(); }
+
+    void clear() {
+        precio.clear(); stock.clear(); vendidos.clear(); categoria.clear();
+        precioCentavos.clear();
+        nombre.clear(); nombresCategoria.clear(); idsCategoria.clear();
+        indicesBaratos.clear(); indicesCaros.clear();
+        aliasBaratos = TablaAlias(); aliasCaros = TablaAlias();
+    }
+
+    // Devuelve el id de la categoría, registrándola si es nueva
+    uint16_t internarCategoria(const string& cat) {
+        auto it = idsCategoria.find(cat);
+        if (it != idsCategoria.end()) return it->second;
+        if ((int)nombresCategoria.size() >= MAX_CATEGORIAS)
+            throw length_error("el catálogo supera " + to_string(MAX_CATEGORIAS) + " categorías");
+        uint16_t id = (uint16_t)nombresCategoria.size();
+        nombresCategoria.push_back(cat);
+        idsCategoria.emplace(cat, id);
+        return id;
+    }
+
+    void agregar(const string& nom, double prec, const string& cat, int stockInicial) {
+        (prec > PRECIO_CARO ? indicesCaros : indicesBaratos).push_back(size());
+        precio.push_back(prec);
+        precioCentavos.push_back((int32_t)llround(prec * 100));
+        stock.push_back(stockInicial);
+        vendidos.push_back(0);
+        categoria.push_back(internarCategoria(cat));
+        nombre.push_back(nom);
+    }
+
+    // Pesos de popularidad por producto: arma las tablas de alias de cada clase
+    void asignarPesos(const vector<double>& pesos) {
+        vector<double> baratos, caros;
+        for (int32_t i : indicesBaratos) baratos.push_back(pesos[i]);
+        for (int32_t i : indicesCaros) caros.push_back(pesos[i]);
+        aliasBaratos = construirTablaAlias(baratos);
+        aliasCaros = construirTablaAlias(caros);
+    }
+
+    // Producto dentro de la clase pedida: uniforme, o según su peso si el
+    // catálogo tiene pesos. Si no hay productos de esa clase se usa la otra.
+    int elegirEnClase(bool caro, uint32_t x) const {
+        bool usarCaros = (caro && !indicesCaros.empty()) || indicesBaratos.empty();
+        const Columna<int32_t>& clase = usarCaros ? indicesCaros : indicesBaratos;
+        const TablaAlias& alias = usarCaros ? aliasCaros : aliasBaratos;
+        if (!alias.empty()) return clase[alias.elegir(x)];
+        return clase[philox::enteroEnRango(x, 0, (int)clase.size() - 1)];
+    }
+};
+
+// Línea del carrito: producto y cantidad
+struct LineaCarrito {
+    uint32_t producto;
+    uint16_t cantidad;
+};
+
+enum class MetodoPago : uint8_t { Efectivo, Tarjeta };
+
+// Estructura para representar un cliente. Es POD: el carrito vive en la arena
+// de líneas del hilo que lo simuló y aquí solo se guarda dónde empieza.
+struct Cliente {
+    const LineaCarrito* carrito;
+    double total;
+    double tiempoCompra; // en segundos
+    int id;
+    int cantidadProductos;
+    float tiempoPago;    // parte de tiempoCompra que pasa en la caja
+    uint16_t numLineas;
+    MetodoPago metodoPago;
+    uint8_t tipo;        // índice en la tabla de perfiles
+};
+
+// Cada hilo escribe lotes enteros de clientes. Si un lote ocupa un número
+// entero de líneas y el arreglo empieza alineado, dos hilos nunca escriben
+// en la misma línea.
+static_assert(TAM_LOTE * sizeof(Cliente) % TAM_LINEA_CACHE == 0,
+              "un lote de clientes debe ocupar líneas de caché completas");
+
+// Asignador que alinea el arreglo al inicio de una línea de caché
+template <class T>
+struct AsignadorAlineado {
+    using value_type = T;
+    AsignadorAlineado() = default;
+    template <class U> AsignadorAlineado(const AsignadorAlineado<U>&) {}
+    // Construir sin inicializar: así el maestro no toca el arreglo entero al
+    // redimensionarlo y cada página la toca primero el hilo que la escribe
+    // (en NUMA, queda en la memoria del nodo de ese hilo)
+    template <class U> void construct(U* p) { ::new ((void*)p) U; }
+    template <class U, class... Args> void construct(U* p, Args&&... args) {
+        ::new ((void*)p) U(std::forward<Args>(args)...);
+    }
+    T* allocate(size_t n) {
+        return static_cast<T*>(::operator new(n * sizeof(T), align_val_t(TAM_LINEA_CACHE)));
+    }
+    void deallocate(T* p, size_t) { ::operator delete(p, align_val_t(TAM_LINEA_CACHE)); }
+    template <class U> bool operator==(const AsignadorAlineado<U>&) const { return true; }
+    template <class U> bool operator!=(const AsignadorAlineado<U>&) const { return false; }
+};
+
+// Arena de líneas de carrito. Reserva bloques grandes que nunca se mueven y
+// cada cliente toma sus líneas con un simple incremento, sin pasar por malloc.
+// Hay una por hilo, alineada para que los contadores no compartan línea.
+class alignas(TAM_LINEA_CACHE) ArenaLineas {
+public:
+    static constexpr size_t LINEAS_POR_BLOQUE = 1 << 16;
+
+    // Espacio contiguo para hasta 'maximo' líneas; confirmar() dice cuántas se usaron
+    LineaCarrito* reservar(size_t maximo) {
+        if (bloques.empty() || usadas + maximo > capacidad) {
+            capacidad = max(LINEAS_POR_BLOQUE, maximo);
+            bloques.emplace_back(new LineaCarrito[capacidad]);
+            lineasReservadas += capacidad;
+            usadas = 0;
+        }
+        return &bloques.back()[usadas];
+    }
+
+    void confirmar(size_t n) { usadas += n; }
+
+    void clear() {
+        bloques.clear();
+        usadas = capacidad = lineasReservadas = 0;
+    }
+
+    size_t bytesReservados() const { return lineasReservadas * sizeof(LineaCarrito); }
+
+private:
+    vector<unique_ptr<LineaCarrito[]>> bloques;
+    size_t usadas = 0;
+    size_t capacidad = 0;
+    size_t lineasReservadas = 0;
+};
+
+// Resumen combinable de un conjunto de clientes. Cada hilo pliega sus
+// clientes en su propio acumulador a medida que los genera y al final se
+// fusionan; con eso el modo streaming no necesita guardar los clientes.
+// Las ventas se suman en centavos enteros por id de categoría: el resultado
+// es exacto y no depende del orden ni de cuántos hilos participaron.
+struct AcumuladorEstadisticas {
+    long long clientes = 0;
+    long long productosVendidos = 0;
+    long long pagosTarjeta = 0;
+    long long pagosEfectivo = 0;
+
+    // Media y suma de cuadrados de desvíos del tiempo de compra (Welford);
+    // se combinan con la fórmula de Chan et al.
+    double tiempoMedio = 0;
+    double tiempoM2 = 0;
+    double tiempoMin = numeric_limits<double>::infinity();
+    double tiempoMax = 0;
+
+    // Compradores por unidades compradas: 1-5, 6-15, 16-30, >30
+    long long compradores[4] = {0, 0, 0, 0};
+    long long porPerfil[MAX_PERFILES] = {};   // clientes de cada tipo
+
+    long long centavosPorCategoria[MAX_CATEGORIAS] = {};
+    long long unidadesPorCategoria[MAX_CATEGORIAS] = {};
+
+    void agregar(const Cliente& c, const Catalogo& catalogo) {
+        clientes++;
+        productosVendidos += c.cantidadProductos;
+        if (c.metodoPago == MetodoPago::Tarjeta) pagosTarjeta++;
+        else pagosEfectivo++;
+
+        double delta = c.tiempoCompra - tiempoMedio;
+        tiempoMedio += delta / clientes;
+        tiempoM2 += delta * (c.tiempoCompra - tiempoMedio);
+        tiempoMin = min(tiempoMin, c.tiempoCompra);
+        tiempoMax = max(tiempoMax, c.tiempoCompra);
+
+        compradores[c.cantidadProductos <= 5 ? 0 : c.cantidadProductos <= 15 ? 1
+                    : c.cantidadProductos <= 30 ? 2 : 3]++;
+        porPerfil[c.tipo]++;
+
+        const int32_t* precioCentavos = catalogo.precioCentavos.data();
+        const uint16_t* categoria = catalogo.categoria.data();
+        for (int j = 0; j < c.numLineas; j++) {
+            uint32_t idProducto = c.carrito[j].producto;
+            int cant = c.carrito[j].cantidad;
+            centavosPorCategoria[categoria[idProducto]] += (long long)precioCentavos[idProducto] * cant;
+            unidadesPorCategoria[categoria[idProducto]] += cant;
+        }
+    }
+
+    void fusionar(const AcumuladorEstadisticas& o) {
+        if (o.clientes == 0) return;
+        long long n = clientes + o.clientes;
+        double delta = o.tiempoMedio - tiempoMedio;
+        tiempoM2 += o.tiempoM2 + delta * delta * ((double)clientes * o.clientes / n);
+        tiempoMedio += delta * ((double)o.clientes / n);
+        tiempoMin = min(tiempoMin, o.tiempoMin);
+        tiempoMax = max(tiempoMax, o.tiempoMax);
+        clientes = n;
+
+        productosVendidos += o.productosVendidos;
+        pagosTarjeta += o.pagosTarjeta;
+        pagosEfectivo += o.pagosEfectivo;
+        for (int b = 0; b < 4; b++) compradores[b] += o.compradores[b];
+        for (int t = 0; t < MAX_PERFILES; t++) porPerfil[t] += o.porPerfil[t];
+        for (int cat = 0; cat < MAX_CATEGORIAS; cat++) {
+            centavosPorCategoria[cat] += o.centavosPorCategoria[cat];
+            unidadesPorCategoria[cat] += o.unidadesPorCategoria[cat];
+        }
+    }
+
+    long long ventasCentavos() const {
+        long long total = 0;
+        for (int cat = 0; cat < MAX_CATEGORIAS; cat++) total += centavosPorCategoria[cat];
+        return total;
+    }
+
+    double ventasTotales() const { return ventasCentavos() / 100.0; }
+
+    double tiempoDesviacion() const {
+        return clientes > 1 ? sqrt(tiempoM2 / (clientes - 1)) : 0.0;
+    }
+};
+
+// Los N productos más vendidos. Mantiene un heap de tamaño N con el peor al
+// frente, así cada inserción cuesta O(log N) sin ordenar todo el catálogo.
+// Los empates se rompen por id, de modo que combinar parciales en cualquier
+// orden da el mismo ranking (ver la reducción 'fusionarTop').
+struct TopProductos {
+    struct Entrada {
+        int vendidos;
+        int producto;
+    };
+
+    int capacidad;
+    vector<Entrada> heap;
+
+    explicit TopProductos(int capacidad = 10) : capacidad(capacidad) {
+        heap.reserve(capacidad);
+    }
+
+    // a va antes que b en el ranking
+    static bool mejor(const Entrada& a, const Entrada& b) {
+        return a.vendidos != b.vendidos ? a.vendidos > b.vendidos : a.producto < b.producto;
+    }
+
+    void agregar(int producto, int vendidos) {
+        Entrada e{vendidos, producto};
+        if ((int)heap.size() < capacidad) {
+            heap.push_back(e);
+            push_heap(heap.begin(), heap.end(), mejor);
+        } else if (capacidad > 0 && mejor(e, heap.front())) {
+            pop_heap(heap.begin(), heap.end(), mejor);
+            heap.back() = e;
+            push_heap(heap.begin(), heap.end(), mejor);
+        }
+    }
+
+    void fusionar(const TopProductos& o) {
+        for (const auto& e : o.heap) agregar(e.producto, e.vendidos);
+    }
+
+    vector<Entrada> ordenados() const {
+        vector<Entrada> v = heap;
+        sort(v.begin(), v.end(), mejor);
+        return v;
+    }
+};
+
+#pragma omp declare reduction(fusionarTop : TopProductos : omp_out.fusionar(omp_in)) \
+    initializer(omp_priv = TopProductos(omp_orig.capacidad))
+
+// Resultado del análisis posterior a la simulación
+struct Analisis {
+    AcumuladorEstadisticas est;
+    vector<TopProductos::Entrada> top;
+    vector<int> stockBajo;      // ids con menos de 100 unidades, en orden
+    double segundos = 0;
+    bool listo = false;
+};
+
+struct ThreadStats {
+    double ventasTotales = 0.0;
+    long long productosVendidos = 0;
+    long long pagosEfectivo = 0;
+    long long pagosTarjeta = 0;
+    long long reservasAtomicas = 0;
+    long long reintentosCAS = 0;    // CAS fallidos por otro hilo tocando el mismo producto
+    long long robosStock = 0;       // veces que se tomó stock del fragmento de otro hilo
+
+    // Como sumidero del kernel: totales de los clientes simulados
+    void agregar(const Cliente& c) {
+        ventasTotales += c.total;
+        productosVendidos += c.cantidadProductos;
+        if (c.metodoPago == MetodoPago::Tarjeta) pagosTarjeta++;
+        else pagosEfectivo++;
+    }
+};
+
+// Cómo se sincroniza el stock en la simulación paralela
+enum class ModoStock {
+    Mutex,      // un std::mutex por producto
+    Atomico,    // reserva lock-free con CAS sobre contadores atómicos
+    Fragmentado // cada hilo posee una porción del stock y roba a sus vecinos
+};
+
+// Contadores de un producto para el modo atómico. Cada producto ocupa su
+// propia línea de caché para que los SKUs vecinos no se invaliden entre sí.
+struct alignas(TAM_LINEA_CACHE) ContadorProductoAtomico {
+    atomic<int> stock{0};
+    atomic<int> vendidos{0};
+};
+
+// Un producto en el modo mutex: el lock y los contadores que protege van
+// juntos en su propia línea, así quien toma el lock ya trae el stock y los
+// productos vecinos no se invalidan entre sí.
+struct alignas(TAM_LINEA_CACHE) ProductoBloqueado {
+    mutex m;
+    int stock = 0;
+    int vendidos = 0;
+};
+
+// Porción del stock de todos los productos que posee un hilo en el modo
+// fragmentado. El dueño es el único que escribe 'vendidos'; los demás hilos
+// solo tocan 'stock' cuando roban porque su propia porción se agotó.
+struct alignas(TAM_LINEA_CACHE) FragmentoStock {
+    unique_ptr<atomic<int>[]> stock;
+    unique_ptr<int[]> vendidos;
+};
+
+// Políticas de stock de simularClienteKernel. tomar() descuenta hasta
+// 'cantidad' unidades del producto y devuelve las que realmente tomó (0 si no
+// hay stock). Como la política es un parámetro de plantilla, la versión de un
+// solo hilo no paga ninguna sincronización.
+
+// Un solo hilo: escribe directo en las columnas del catálogo
+struct StockDirecto {
+    int32_t* stock;
+    int* vendidos;
+
+    int tomar(int p, int cantidad) {
+        if (stock[p] <= 0) return 0;
+        cantidad = min(cantidad, (int)stock[p]);
+        stock[p] -= cantidad;
+        vendidos[p] += cantidad;
+        return cantidad;
+    }
+};
+
+// Un mutex por producto. Si el lock está tomado la espera se anota en la
+// traza (cuando hay traza)
+struct StockConMutex {
+    ProductoBloqueado* productos;
+    AnilloTraza* traza = nullptr;
+
+    int tomar(int p, int cantidad) {
+        ProductoBloqueado& prod = productos[p];
+        if (!traza) {
+            prod.m.lock();
+        } else if (!prod.m.try_lock()) {
+            EventoTrazado espera(traza, TRAZA_ESPERA_LOCK, p);
+            prod.m.lock();
+        }
+        lock_guard<mutex> g(prod.m, adopt_lock);
+        if (prod.stock <= 0) return 0;
+        cantidad = min(cantidad, prod.stock);
+        prod.stock -= cantidad;
+        prod.vendidos += cantidad;
+        return cantidad;
+    }
+};
+
+// Como StockConMutex, pero cuenta tomas, tomas contendidas y espera de cada
+// producto (contencion_locks.hpp). Cada hilo instrumenta una de cada
+// 'muestreo' tomas; las demás van directo a lock().
+struct StockConMutexMedido {
+    ProductoBloqueado* productos;
+    ContencionProducto* contencion;
+    AnilloTraza* traza;
+    uint32_t muestreo;
+    uint32_t cuenta = 0;
+
+    int tomar(int p, int cantidad) {
+        ProductoBloqueado& prod = productos[p];
+        if (++cuenta < muestreo) {
+            prod.m.lock();
+        } else {
+            cuenta = 0;
+            bool contendida = !prod.m.try_lock();
+            uint64_t espera = 0;
+            if (contendida) {
+                uint64_t t0 = ticksTraza();
+                prod.m.lock();
+                uint64_t t1 = ticksTraza();
+                espera = t1 - t0;
+                if (traza) traza->registrar(TRAZA_ESPERA_LOCK, t0, t1, p);
+            }
+            contencion[p].anotar(contendida, espera);
+        }
+        lock_guard<mutex> g(prod.m, adopt_lock);
+        if (prod.stock <= 0) return 0;
+        cantidad = min(cantidad, prod.stock);
+        prod.stock -= cantidad;
+        prod.vendidos += cantidad;
+        return cantidad;
+    }
+};
+
+// Toma hasta 'cantidad' unidades de un contador de stock compartido
+inline int tomarStockCAS(atomic<int>& contador, int cantidad, ThreadStats& ts) {
+    int disponible = contador.load(memory_order_relaxed);
+    while (disponible > 0) {
+        int tomada = min(cantidad, disponible);
+        if (contador.compare_exchange_weak(disponible, disponible - tomada, memory_order_relaxed))
+            return tomada;
+        // 'disponible' quedó actualizado con el valor que otro hilo escribió
+        ts.reintentosCAS++;
+    }
+    return 0;
+}
+
+// Reserva lock-free con CAS sobre el contador del producto
+struct StockAtomico {
+    ContadorProductoAtomico* contadores;
+    ThreadStats& ts;
+
+    int tomar(int p, int cantidad) {
+        ts.reservasAtomicas++;
+        int tomada = tomarStockCAS(contadores[p].stock, cantidad, ts);
+        if (tomada > 0) contadores[p].vendidos.fetch_add(tomada, memory_order_relaxed);
+        return tomada;
+    }
+};
+
+// Reserva en el fragmento del hilo; lo que falte lo roba de los hermanos,
+// en orden, hasta completar 'cantidad' o recorrerlos todos. De cada hermano
+// se lleva al menos la mitad de su stock y guarda en el propio lo que sobra.
+// Así un cliente recibe lo mismo que con el stock compartido.
+struct StockFragmentado {
+    FragmentoStock* fragmentos;
+    int numFragmentos;
+    int hilo;
+    ThreadStats& ts;
+
+    int tomar(int p, int cantidad) {
+        FragmentoStock& propio = fragmentos[hilo];
+        int tomada = tomarStockCAS(propio.stock[p], cantidad, ts);
+
+        for (int k = 1; tomada < cantidad && k < numFragmentos; k++) {
+            atomic<int>& ajeno = fragmentos[(hilo + k) % numFragmentos].stock[p];
+            int falta = cantidad - tomada;
+            int disponible = ajeno.load(memory_order_relaxed);
+            while (disponible > 0) {
+                int lote = max(min(falta, disponible), disponible / 2);
+                if (ajeno.compare_exchange_weak(disponible, disponible - lote, memory_order_relaxed)) {
+                    tomada += min(falta, lote);
+                    if (lote > falta) propio.stock[p].fetch_add(lote - falta, memory_order_relaxed);
+                    ts.robosStock++;
+                    break;
+                }
+                ts.reintentosCAS++;
+            }
+        }
+
+        propio.vendidos[p] += tomada;
+        return tomada;
+    }
+};
+
+// Kernel de un cliente, compartido por todos los motores: elige los
+// productos, descuenta stock y arma el carrito en la arena. Cambian el
+// generador de las líneas (Rng::siguiente()), la política de stock (ver
+// arriba) y dónde se acumulan los totales (Sumidero::agregar(cliente)).
+// Con guardarLineas = false (streaming) las líneas no se confirman en la
+// arena y el próximo cliente reusa el espacio.
+template <class Rng, class Stock, class Sumidero>
+inline Cliente simularClienteKernel(int id, const CabeceraCliente& cab, const Catalogo& catalogo,
+                                    Rng& rng, Stock& stock, Sumidero& sumidero,
+                                    ArenaLineas& arena, bool guardarLineas) {
+    Cliente cliente;
+    cliente.id = id;
+    cliente.total = 0;
+    cliente.cantidadProductos = 0;
+    cliente.tipo = (uint8_t)cab.tipo;
+
+    double probProductoCaro = cab.probProductoCaro;
+    const double* precio = catalogo.precio.data();
+    LineaCarrito* carrito = arena.reservar(cab.productos);
+    int numLineas = 0;
+
+    for (int i = 0; i < cab.productos; i++) {
+        // Clase de precio y producto de esa clase, directo desde el índice
+        bool elegirCaro = philox::uniforme01(rng.siguiente()) < probProductoCaro;
+        int idProducto = catalogo.elegirEnClase(elegirCaro, rng.siguiente());
+
+        // La cantidad (1-3) se sortea aunque no haya stock, así el flujo del
+        // cliente no depende del estado del inventario
+        int cantidad = stock.tomar(idProducto, philox::enteroEnRango(rng.siguiente(), 1, 3));
+        if (cantidad > 0) {
+            carrito[numLineas++] = {(uint32_t)idProducto, (uint16_t)cantidad};
+            cliente.total += precio[idProducto] * cantidad;
+            cliente.cantidadProductos += cantidad;
+        }
+    }
+
+    if (guardarLineas) arena.confirmar(numLineas);
+    cliente.carrito = carrito;
+    cliente.numLineas = (uint16_t)numLineas;
+
+    // El tiempo de pago de la cabecera ya viene reducido para tarjeta
+    cliente.metodoPago = cab.tarjeta ? MetodoPago::Tarjeta : MetodoPago::Efectivo;
+    cliente.tiempoCompra = cab.tiempoSeleccion + cab.tiempoPago;
+    cliente.tiempoPago = (float)cab.tiempoPago;
+
+    sumidero.agregar(cliente);
+    return cliente;
+}
+
+// Nombres de los perfiles incorporados (PERFILES), para los reportes
+const vector<string> NOMBRES_PERFILES = {"pequeño", "promedio", "familiar", "mayorista"};
+
+// Tabla de perfiles leída de un archivo: los pesos pasan a probabilidades
+// acumuladas. Los mismos cuatro perfiles con pesos 20/40/25/15 dan la misma
+// tabla que la incorporada.
+inline TablaPerfiles tablaDePerfiles(const vector<PerfilArchivo>& perfiles) {
+    if (perfiles.empty() || perfiles.size() > (size_t)MAX_PERFILES)
+        throw invalid_argument("se admiten de 1 a " + to_string(MAX_PERFILES) + " perfiles");
+    double total = 0;
+    for (const auto& p : perfiles) total += p.peso;
+    TablaPerfiles t;
+    t.n = (int)perfiles.size();
+    double acumulado = 0;
+    for (int i = 0; i < t.n; i++) {
+        const PerfilArchivo& p = perfiles[i];
+        acumulado += p.peso;
+        t.umbral[i] = (i == t.n - 1) ? 1.0 : acumulado / total;
+        t.minProductos[i] = p.minProductos;
+        t.maxProductos[i] = p.maxProductos;
+        t.rangoProductos[i] = p.maxProductos - p.minProductos + 1;
+        t.probProductoCaro[i] = p.probCaro;
+    }
+    return t;
+}
+
+// Dominio del flujo Philox que decide el stock inicial (los clientes usan
+// DOMINIO_CLIENTES, ver lote_clientes.hpp)
+constexpr uint32_t DOMINIO_INVENTARIO = 1;
+
+inline uint64_t semillaAleatoria() {
+    random_device rd;
+    return ((uint64_t)rd() << 32) ^ rd();
+}
+
+// Clase principal del simulador
+class SimuladorSupermercado {
+private:
+    Catalogo inventario;
+    vector<Cliente, AsignadorAlineado<Cliente>> clientes;
+    vector<ArenaLineas> arenas;     // una por hilo; la 0 es la del modo secuencial
+    
+    // Modo streaming: no se guardan los clientes, solo 'acumulado'
+    bool modoStreaming = false;
+    AcumuladorEstadisticas acumulado;
+    
+    Analisis analisis;
+    uint64_t semilla;
+    NivelSimd nivelSimd = detectarNivelSimd();
+    vector<ProductoBloqueado> stockBloqueado;
+    vector<ContadorProductoAtomico> stockAtomico;
+    vector<FragmentoStock> fragmentos;
+    ModoStock modoStock = ModoStock::Mutex;
+    Planificacion planificacion = Planificacion::Estatica;
+    vector<EstadisticasHilo> repartoHilos;  // del último ejecutarSimulacionOMP
+    Afinidad afinidad = Afinidad::Ninguna;
+    TablaPerfiles perfiles = PERFILES_BASE;
+    vector<string> nombresPerfiles = NOMBRES_PERFILES;
+    
+    bool verboso = true;            // mensajes de progreso por consola
+    unique_ptr<PerfilHw> perfilHw;  // solo si se piden contadores de hardware
+    unique_ptr<Traza> traza;        // solo si se pide la traza
+    unique_ptr<PerfilLocks> perfilLocks;  // solo si se mide la contención en modo mutex
+    unique_ptr<RegistroTransacciones> registro;   // solo si se pide el registro
+    double tiempoCierreRegistro = 0;
+    
+    // Instantáneas para reanudar una corrida interrumpida (instantanea.hpp)
+    using EstadoGuardado = Instantanea<AcumuladorEstadisticas, ThreadStats>;
+    string rutaInstantanea;
+    long long clientesPorTramo = 0;   // 0 = sin instantáneas
+    bool reanudarSiExiste = false;
+    long long reanudadoDesde = 0;     // id con el que siguió la corrida (0 = desde el principio)
+    int instantaneasEscritas = 0;
+    double tiempoSimulacion = 0;
+    int hilosUsados = 1;
+
+    // Estadísticas globales
+    double ventasTotales = 0;
+    long long productosVendidos = 0;
+    double tiempoPromedioCompra = 0;
+    long long pagosEfectivo = 0;
+    long long pagosTarjeta = 0;
+    long long reservasAtomicas = 0;
+    long long reintentosCAS = 0;
+    long long robosStock = 0;
+    
+public:
+    explicit SimuladorSupermercado(uint64_t semilla = semillaAleatoria()) : semilla(semilla) {
+        inicializarInventario();
+    }
+    
+    uint64_t getSemilla() const { return semilla; }
+    
+    const Catalogo& getInventario() const { return inventario; }
+    
+    // Estadísticas acumuladas en modo streaming
+    const AcumuladorEstadisticas& getAcumulado() const { return acumulado; }
+    
+    // En modo streaming cada cliente se pliega en un acumulador al generarse
+    // y se descarta, así la memoria no crece con la cantidad de clientes
+    void setModoStreaming(bool activo) { modoStreaming = activo; }
+    
+    // Permite forzar el camino escalar (o uno SIMD más angosto) para comparar
+    void setNivelSimd(NivelSimd nivel) {
+        if (nivel < nivelSimd) nivelSimd = nivel;
+    }
+    
+    // Sin mensajes por consola (para salida JSON/CSV o corridas en lote)
+    void setVerboso(bool activo) { verboso = activo; }
+    
+    double getTiempoSimulacion() const { return tiempoSimulacion; }
+    
+    // Reparto de los lotes de clientes entre hilos en ejecutarSimulacionOMP.
+    // El costo de un cliente varía mucho (de 1 a 50 productos), así que con
+    // reparto estático algunos hilos terminan bastante después que otros.
+    void setPlanificacion(Planificacion p) { planificacion = p; }
+    
+    // Fijar los hilos de ejecutarSimulacionOMP a CPU según los nodos NUMA
+    void setAfinidad(Afinidad a) { afinidad = a; }
+    
+    // Tipos de comprador (por defecto los de PERFILES)
+    void setPerfiles(const vector<PerfilArchivo>& lista) {
+        perfiles = tablaDePerfiles(lista);
+        nombresPerfiles.clear();
+        for (const auto& p : lista) nombresPerfiles.push_back(p.nombre);
+    }
+    
+    const TablaPerfiles& getPerfiles() const { return perfiles; }
+    
+    // Tiempo ocupado y ocioso de cada hilo en la fase de generación
+    const vector<EstadisticasHilo>& getRepartoHilos() const { return repartoHilos; }
+    
+    // Contadores de hardware por fase y por hilo (ver contadores_hw.hpp).
+    // Se acumulan sobre todas las fases medidas hasta que se vuelva a activar.
+    void setMedirContadores(bool activo) {
+        perfilHw.reset(activo ? new PerfilHw() : nullptr);
+    }
+    
+    const PerfilHw* getPerfilHw() const { return perfilHw.get(); }
+    
+    // Línea de tiempo por hilo de clientes, lotes, esperas y fases, con
+    // 'eventosPorHilo' como tamaño de cada anillo (ver traza.hpp)
+    void setTraza(bool activa, size_t eventosPorHilo = 1 << 18) {
+        traza.reset(activa ? new Traza(eventosPorHilo) : nullptr);
+    }
+    
+    const Traza* getTraza() const { return traza.get(); }
+    
+    AnilloTraza* anilloTraza(int hilo) const { return traza ? traza->hilo(hilo) : nullptr; }
+    
+    // Contención de los locks por producto en el modo mutex: tomas, tomas
+    // contendidas y espera de cada producto. Con 'muestreo' N se instrumenta
+    // una de cada N tomas de cada hilo (ver contencion_locks.hpp).
+    void setMedirLocks(bool activo, int muestreo = 1) {
+        perfilLocks.reset(activo ? new PerfilLocks() : nullptr);
+        if (perfilLocks) perfilLocks->muestreo = max(1, muestreo);
+    }
+    
+    const PerfilLocks* getPerfilLocks() const { return perfilLocks.get(); }
+    
+    void escribirTraza(const string& ruta) const {
+        if (!traza) return;
+        traza->escribirChrome(ruta);
+        if (verboso) {
+            cout << "Traza: " << traza->eventos() << " eventos (" << traza->perdidos()
+                 << " pisados por anillo lleno) en " << ruta << endl;
+        }
+    }
+    
+    // Guarda el estado en 'ruta' cada 'cadaClientes' clientes (redondeado a
+    // lotes enteros) y al terminar. Con 'reanudar', si 'ruta' ya existe la
+    // corrida sigue desde ahí con la semilla de la instantánea. Solo en modo
+    // streaming: los clientes guardados no entran en la instantánea.
+    void setInstantaneas(const string& ruta, long long cadaClientes, bool reanudar) {
+        rutaInstantanea = ruta;
+        clientesPorTramo = max<long long>(cadaClientes, 1);
+        reanudarSiExiste = reanudar;
+    }
+    
+    // Huella del catálogo y los perfiles (no del stock, que va en la instantánea)
+    uint64_t huellaSimulacion() const {
+        int n = inventario.size();
+        uint64_t h = fnv1a(&n, sizeof(n));
+        h = fnv1a(inventario.precioCentavos.data(), n * sizeof(int32_t), h);
+        h = fnv1a(inventario.categoria.data(), n * sizeof(uint16_t), h);
+        for (int i = 0; i < n; i++) {
+            // Largo y bytes: los nombres van pegados en PoolTextos, sin separador
+            string_view nom = inventario.nombre[i];
+            uint32_t largo = (uint32_t)nom.size();
+            h = fnv1a(&largo, sizeof(largo), h);
+            h = fnv1a(nom.data(), nom.size(), h);
+        }
+        for (const TablaAlias* a : {&inventario.aliasBaratos, &inventario.aliasCaros}) {
+            h = fnv1a(a->prob.data(), a->size() * sizeof(uint32_t), h);
+            h = fnv1a(a->alias.data(), a->size() * sizeof(int32_t), h);
+        }
+        h = fnv1a(&perfiles.n, sizeof(perfiles.n), h);
+        h = fnv1a(perfiles.umbral, perfiles.n * sizeof(double), h);
+        h = fnv1a(perfiles.minProductos, perfiles.n * sizeof(int32_t), h);
+        h = fnv1a(perfiles.maxProductos, perfiles.n * sizeof(int32_t), h);
+        return fnv1a(perfiles.probProductoCaro, perfiles.n * sizeof(double), h);
+    }
+    
+    // Guarda cada cliente simulado (con sus líneas) en 'ruta' mientras se
+    // simula; funciona también en streaming. Ver registro_transacciones.hpp.
+    void abrirRegistro(const string& ruta) {
+        registro.reset(new RegistroTransacciones(ruta, semilla));
+        tiempoCierreRegistro = 0;
+    }
+    
+    // Espera a que se escriba lo que queda en los buffers. Lanza si falló
+    // alguna escritura.
+    void cerrarRegistro() {
+        if (!registro) return;
+        auto t0 = steady_clock::now();
+        registro->cerrar();
+        tiempoCierreRegistro = duration<double>(steady_clock::now() - t0).count();
+        if (verboso) {
+            double mb = registro->bytesEscritos() / (1024.0 * 1024.0);
+            double segundos = tiempoSimulacion + tiempoCierreRegistro;
+            cout << "Registro de transacciones: " << registro->clientes() << " clientes, "
+                 << registro->lineas() << " líneas, " << fixed << setprecision(2) << mb << " MB ("
+                 << (registro->clientes() > 0 ? (double)registro->bytesEscritos() / registro->clientes() : 0.0)
+                 << " bytes/cliente, " << (segundos > 0 ? mb / segundos : 0.0) << " MB/s, espera "
+                 << setprecision(3) << registro->segundosEspera() << " s)" << endl;
+        }
+    }
+    
+    void inicializarInventario() {
+        // 50 productos organizados por categorías con precios variados
+        vector<ProductoArchivo> productosData = {
+            // Frutas y Verduras (10 productos)
+            {"Manzanas (kg)", 2.50, "Frutas"},
+            {"Plátanos (kg)", 1.80, "Frutas"},
+            {"Naranjas (kg)", 2.20, "Frutas"},
+            {"Tomates (kg)", 3.00, "Verduras"},
+            {"Lechuga", 1.50, "Verduras"},
+            {"Papas (kg)", 1.20, "Verduras"},
+            {"Zanahorias (kg)", 1.80, "Verduras"},
+            {"Cebolla (kg)", 1.50, "Verduras"},
+            {"Pimientos (kg)", 3.50, "Verduras"},
+            {"Aguacates", 4.00, "Frutas"},
+            
+            // Lácteos (8 productos)
+            {"Leche (1L)", 1.20, "Lácteos"},
+            {"Yogurt Natural", 2.50, "Lácteos"},
+            {"Queso Fresco", 5.50, "Lácteos"},
+            {"Mantequilla", 3.20, "Lácteos"},
+            {"Crema", 2.80, "Lácteos"},
+            {"Queso Mozzarella", 6.00, "Lácteos"},
+            {"Yogurt Griego", 3.50, "Lácteos"},
+            {"Leche Deslactosada", 1.80, "Lácteos"},
+            
+            // Carnes (8 productos)
+            {"Pollo (kg)", 8.50, "Carnes"},
+            {"Carne Molida (kg)", 12.00, "Carnes"},
+            {"Bistec (kg)", 18.00, "Carnes"},
+            {"Chuletas Cerdo (kg)", 15.00, "Carnes"},
+            {"Pescado Tilapia (kg)", 10.00, "Carnes"},
+            {"Salchichas", 4.50, "Carnes"},
+            {"Jamón (250g)", 5.00, "Carnes"},
+            {"Tocino", 7.50, "Carnes"},
+            
+            // Panadería (6 productos)
+            {"Pan Blanco", 2.00, "Panadería"},
+            {"Pan Integral", 2.50, "Panadería"},
+            {"Croissants (3pz)", 3.50, "Panadería"},
+            {"Tortillas (kg)", 1.50, "Panadería"},
+            {"Pan Dulce", 2.80, "Panadería"},
+            {"Galletas", 3.00, "Panadería"},
+            
+            // Bebidas (8 productos)
+            {"Coca-Cola 2L", 2.50, "Bebidas"},
+            {"Agua 1L", 0.80, "Bebidas"},
+            {"Jugo Naranja 1L", 3.50, "Bebidas"},
+            {"Cerveza (6 pack)", 8.00, "Bebidas"},
+            {"Vino Tinto", 12.00, "Bebidas"},
+            {"Café Molido", 6.50, "Bebidas"},
+            {"Té Verde", 4.00, "Bebidas"},
+            {"Bebida Energética", 3.00, "Bebidas"},
+            
+            // Abarrotes (10 productos)
+            {"Arroz (kg)", 2.20, "Abarrotes"},
+            {"Frijoles (kg)", 3.00, "Abarrotes"},
+            {"Pasta (500g)", 1.80, "Abarrotes"},
+            {"Aceite (1L)", 4.50, "Abarrotes"},
+            {"Azúcar (kg)", 1.50, "Abarrotes"},
+            {"Sal (kg)", 0.80, "Abarrotes"},
+            {"Harina (kg)", 1.20, "Abarrotes"},
+            {"Cereal", 5.50, "Abarrotes"},
+            {"Salsa Tomate", 2.00, "Abarrotes"},
+            {"Mayonesa", 3.50, "Abarrotes"}
+        };
+        
+        cargarCatalogo(productosData);
+    }
+    
+    // Reemplaza el catálogo actual. Los productos sin stock explícito reciben
+    // uno sorteado entre 500 y 1500, igual que el catálogo incorporado.
+    void cargarCatalogo(const vector<ProductoArchivo>& productos) {
+        if (perfilHw) perfilHw->preparar(1);
+        MedicionFase medicion(perfilHw.get(), FASE_INVENTARIO, 0);
+        inventario.clear();
+        philox::Flujo flujoInventario(semilla, 0, DOMINIO_INVENTARIO);
+        bool conPesos = false;
+        for (const auto& p : productos) {
+            int stockInicial = 500 + (flujoInventario.siguiente() % 1000); // Stock inicial entre 500-1500
+            inventario.agregar(p.nombre, p.precio, p.categoria, p.stock >= 0 ? p.stock : stockInicial);
+            conPesos = conPesos || p.peso >= 0;
+        }
+        if (conPesos) {
+            vector<double> pesos;
+            for (const auto& p : productos) pesos.push_back(p.peso >= 0 ? p.peso : 1.0);
+            inventario.asignarPesos(pesos);
+        }
+    }
+    
+    // Carga un catálogo columnar (catalogo_columnar.hpp) sin copiarlo: las
+    // columnas quedan mapeadas desde el archivo. Da el mismo catálogo que
+    // cargarCatalogo con la lista de la que salió el archivo.
+    void cargarCatalogoColumnar(const string& ruta) {
+        if (perfilHw) perfilHw->preparar(1);
+        MedicionFase medicion(perfilHw.get(), FASE_INVENTARIO, 0);
+        MapaCatalogo m = abrirCatalogoColumnar(ruta);
+        if (m.categorias.size() > (size_t)MAX_CATEGORIAS)
+            throw length_error("el catálogo supera " + to_string(MAX_CATEGORIAS) + " categorías");
+        int n = (int)m.precio.size();
+        inventario.clear();
+        inventario.precio = move(m.precio);
+        inventario.precioCentavos = move(m.precioCentavos);
+        inventario.stock = move(m.stock);
+        inventario.categoria = move(m.categoria);
+        inventario.nombre = move(m.nombre);
+        for (const string& cat : m.categorias) inventario.internarCategoria(cat);
+        inventario.vendidos.assign(n, 0);
+
+        if (m.precioCaro == PRECIO_CARO) {
+            inventario.indicesBaratos = move(m.indicesBaratos);
+            inventario.indicesCaros = move(m.indicesCaros);
+            inventario.aliasBaratos = move(m.aliasBaratos);
+            inventario.aliasCaros = move(m.aliasCaros);
+        } else {
+            // Archivo armado con otro umbral: se rehacen las clases
+            for (int p = 0; p < n; p++)
+                (inventario.precio[p] > PRECIO_CARO ? inventario.indicesCaros : inventario.indicesBaratos).push_back(p);
+            if (!m.peso.empty()) inventario.asignarPesos(vector<double>(m.peso.begin(), m.peso.end()));
+        }
+
+        // Mismo sorteo que cargarCatalogo: uno por producto, se use o no
+        if (m.stockSorteado) {
+            philox::Flujo flujoInventario(semilla, 0, DOMINIO_INVENTARIO);
+            for (int p = 0; p < n; p++) {
+                int stockInicial = 500 + (flujoInventario.siguiente() % 1000);
+                if (inventario.stock[p] < 0) inventario.stock[p] = stockInicial;
+            }
+        }
+    }
+    
+    // Pliega los clientes guardados (modo no streaming) en paralelo: cada hilo
+    // llena su propio acumulador de tamaño fijo y al final se reducen en orden
+    // de hilo, así el resultado no depende de cuál terminó primero.
+    AcumuladorEstadisticas agregarClientes() const {
+        long long n = (long long)clientes.size();
+        vector<AcumuladorEstadisticas> parciales(omp_get_max_threads());
+        if (perfilHw) perfilHw->preparar(omp_get_max_threads());
+        if (traza) traza->preparar(omp_get_max_threads());
+        
+        #pragma omp parallel
+        {
+            MedicionFase medicion(perfilHw.get(), FASE_AGREGACION, omp_get_thread_num());
+            EventoTrazado evento(anilloTraza(omp_get_thread_num()), TRAZA_AGREGACION);
+            AcumuladorEstadisticas acc;
+            #pragma omp for schedule(static)
+            for (long long i = 0; i < n; i++) acc.agregar(clientes[i], inventario);
+            parciales[omp_get_thread_num()] = acc;
+        }
+        
+        AcumuladorEstadisticas total;
+        for (const auto& p : parciales) total.fusionar(p);
+        return total;
+    }
+    
+    double memoriaClientesMB() const {
+        size_t bytes = clientes.capacity() * sizeof(Cliente);
+        for (const auto& a : arenas) bytes += a.bytesReservados();
+        return bytes / (1024.0 * 1024.0);
+    }
+    
+    // modo: 1 secuencial, 2 + ModoStock en paralelo (la numeración de --modo)
+    void guardarInstantanea(int modo, long long totalClientes, long long siguienteId,
+                            const ThreadStats& totales) {
+        EventoTrazado evento(anilloTraza(0), TRAZA_INSTANTANEA, (int32_t)siguienteId);
+        EstadoGuardado inst;
+        inst.cab.modo = modo;
+        inst.cab.semilla = semilla;
+        inst.cab.huella = huellaSimulacion();
+        inst.cab.totalClientes = totalClientes;
+        inst.cab.siguienteId = siguienteId;
+        inst.cab.clientesPorTramo = clientesPorTramo;
+        inst.acumulado = acumulado;
+        inst.totales = totales;
+        inst.stock.assign(inventario.stock.begin(), inventario.stock.end());
+        inst.vendidos.assign(inventario.vendidos.begin(), inventario.vendidos.end());
+        escribirInstantanea(rutaInstantanea, inst);
+        instantaneasEscritas++;
+    }
+    
+    // Devuelve el primer id a simular: 1, o el siguiente de la instantánea si
+    // se reanuda. En ese caso deja stock, vendidos y 'acumulado' como estaban
+    // y devuelve en 'totales' los totales guardados.
+    long long restaurarInstantanea(int modo, long long totalClientes, ThreadStats& totales) {
+        reanudadoDesde = 0;
+        instantaneasEscritas = 0;
+        if (clientesPorTramo == 0) return 1;
+        if (!modoStreaming) throw logic_error("las instantáneas necesitan el modo streaming");
+        EstadoGuardado inst;
+        if (!reanudarSiExiste || !leerInstantanea(rutaInstantanea, inst, (uint32_t)inventario.size())) return 1;
+        
+        const CabeceraInstantanea& cab = inst.cab;
+        string donde = rutaInstantanea + ": ";
+        if ((int)cab.modo != modo)
+            throw runtime_error(donde + "la instantánea es del modo " + nombreModo(cab.modo));
+        if (cab.totalClientes != totalClientes)
+            throw runtime_error(donde + "la instantánea es de una corrida de " +
+                                to_string(cab.totalClientes) + " clientes");
+        if (cab.huella != huellaSimulacion())
+            throw runtime_error(donde + "el catálogo o los perfiles no son los de la instantánea");
+        if (cab.siguienteId < 1 || cab.siguienteId > totalClientes + 1 ||
+            ((cab.siguienteId - 1) % TAM_LOTE != 0 && cab.siguienteId != totalClientes + 1))
+            throw runtime_error(donde + "posición de reanudación inválida");
+        
+        semilla = cab.semilla;
+        clientesPorTramo = cab.clientesPorTramo;   // mismos tramos que la corrida original
+        copy(inst.stock.begin(), inst.stock.end(), inventario.stock.begin());
+        copy(inst.vendidos.begin(), inst.vendidos.end(), inventario.vendidos.begin());
+        acumulado = inst.acumulado;
+        totales = inst.totales;
+        reanudadoDesde = cab.siguienteId;
+        return cab.siguienteId;
+    }
+    
+    int lotesPorTramo() const { return (int)max<long long>(1, clientesPorTramo / TAM_LOTE); }
+    
+    void ejecutarSimulacion(int numClientes) {
+        ThreadStats guardados;
+        long long siguienteId = restaurarInstantanea(1, numClientes, guardados);
+        if (!reanudadoDesde) acumulado = AcumuladorEstadisticas();
+        
+        if (verboso) {
+            cout << "\n=== INICIANDO SIMULACIÓN DE SUPERMERCADO ===" << endl;
+            cout << "Simulando " << numClientes << " clientes..." << endl;
+            cout << "Semilla: " << semilla << " | Lotes: " << nombreNivelSimd(nivelSimd) << endl;
+            if (reanudadoDesde) cout << "Reanudando en el cliente " << reanudadoDesde << " (" << rutaInstantanea << ")" << endl;
+            cout << "----------------------------------------" << endl;
+        }
+        
+        auto inicioSimulacion = high_resolution_clock::now();
+        
+        analisis.listo = false;
+        hilosUsados = 1;
+        repartoHilos.clear();
+        if (arenas.empty()) arenas.resize(1);
+        if (!modoStreaming) clientes.reserve(clientes.size() + numClientes);
+        if (registro) registro->preparar(1);
+        
+        if (perfilHw) perfilHw->preparar(1);
+        if (traza) traza->preparar(1);
+        {
+            // En streaming la agregación va dentro del mismo bucle y se cuenta
+            // como generación
+            MedicionFase medicion(perfilHw.get(), FASE_GENERACION, 0);
+            AnilloTraza* anillo = anilloTraza(0);
+            
+            LoteCabeceras lote;
+            ThreadStats ts = guardados;
+            StockDirecto stock{inventario.stock.data(), inventario.vendidos.data()};
+            for (int primerId = (int)siguienteId; primerId <= numClientes; primerId += TAM_LOTE) {
+                EventoTrazado eventoLote(anillo, TRAZA_LOTE, primerId);
+                int n = min(TAM_LOTE, numClientes - primerId + 1);
+                generarCabeceras(semilla, primerId, n, lote, nivelSimd, perfiles);
+            
+                for (int k = 0; k < n; k++) {
+                    int i = primerId + k;
+                    EventoTrazado eventoCliente(anillo, TRAZA_CLIENTE, i);
+                    // Las líneas usan el resto del flujo propio del cliente
+                    philox::Flujo flujo(semilla, i, DOMINIO_CLIENTES, BLOQUE_LINEAS);
+                    Cliente c = simularClienteKernel(i, lote.cabecera(k, perfiles), inventario, flujo, stock, ts,
+                                                     arenas[0], !modoStreaming);
+                    if (registro) registro->agregar(0, c);
+                    if (modoStreaming) acumulado.agregar(c, inventario);
+                    else clientes.push_back(c);
+                
+                    // Mostrar progreso cada 500 clientes
+                    if (verboso && i % 500 == 0) {
+                        cout << "Clientes procesados: " << i << "/" << numClientes << endl;
+                    }
+                }
+                if (registro) registro->cerrarBloque(0);
+                
+                // Los totales del tramo en curso van tal cual: al reanudar se
+                // sigue sumando sobre los mismos valores, bit a bit
+                int ultimo = primerId + n - 1;
+                if (clientesPorTramo > 0 &&
+                    (ultimo == numClientes || (ultimo / TAM_LOTE) % lotesPorTramo() == 0))
+                    guardarInstantanea(1, numClientes, ultimo + 1, ts);
+            }
+            ventasTotales += ts.ventasTotales;
+            productosVendidos += ts.productosVendidos;
+            pagosTarjeta += ts.pagosTarjeta;
+            pagosEfectivo += ts.pagosEfectivo;
+        }
+        
+        auto finSimulacion = high_resolution_clock::now();
+        duration<double> duracionTotal = finSimulacion - inicioSimulacion;
+        tiempoSimulacion = duracionTotal.count();
+        
+        if (verboso) {
+            cout << "\nSimulación completada en " << fixed << setprecision(2) 
+                 << duracionTotal.count() << " segundos" << endl;
+            cout << "Memoria de clientes y carritos: " << memoriaClientesMB() << " MB" << endl;
+        }
+    }
+    // Cada hilo reserva y llena su propio fragmento (primer toque local). El
+    // stock de cada producto se reparte en partes iguales; el resto va a los
+    // primeros hilos. Debe llamarse desde dentro de la región paralela.
+    void repartirStockEnFragmentos(int tid, int numHilos) {
+        #pragma omp single
+        fragmentos = vector<FragmentoStock>(numHilos);
+
+        int n = inventario.size();
+        FragmentoStock& f = fragmentos[tid];
+        f.stock.reset(new atomic<int>[n]);
+        f.vendidos.reset(new int[n]);
+        for (int p = 0; p < n; p++) {
+            int parte = inventario.stock[p] / numHilos
+                      + (tid < inventario.stock[p] % numHilos ? 1 : 0);
+            f.stock[p].store(parte, memory_order_relaxed);
+            f.vendidos[p] = 0;
+        }
+    }
+
+    // Simula los lotes [desde, hasta) con todos los hilos y deja el stock, los
+    // totales y 'acumulado' de vuelta en el catálogo y los miembros
+    void simularTramoOMP(int desde, int hasta, int numClientes, int numThreads) {
+        if (modoStock == ModoStock::Atomico) {
+            MedicionFase medicion(perfilHw.get(), FASE_INVENTARIO, 0);
+            EventoTrazado evento(anilloTraza(0), TRAZA_INVENTARIO);
+            stockAtomico = vector<ContadorProductoAtomico>(inventario.size());
+            for (int p = 0; p < inventario.size(); p++) {
+                stockAtomico[p].stock.store(inventario.stock[p], memory_order_relaxed);
+                stockAtomico[p].vendidos.store(inventario.vendidos[p], memory_order_relaxed);
+            }
+        } else if (modoStock == ModoStock::Mutex) {
+            MedicionFase medicion(perfilHw.get(), FASE_INVENTARIO, 0);
+            EventoTrazado evento(anilloTraza(0), TRAZA_INVENTARIO);
+            stockBloqueado = vector<ProductoBloqueado>(inventario.size());
+            for (int p = 0; p < inventario.size(); p++) {
+                stockBloqueado[p].stock = inventario.stock[p];
+                stockBloqueado[p].vendidos = inventario.vendidos[p];
+            }
+        }
+
+        vector<AcumuladorEstadisticas> parciales(numThreads);
+        RepartoRobo reparto;
+        if (planificacion == Planificacion::Robo) reparto.preparar(hasta - desde, numThreads);
+
+        double ventasTotales_local = 0.0;
+        long long productosVendidos_local = 0;
+        long long pagosEfectivo_local = 0;
+        long long pagosTarjeta_local = 0;
+        long long reservasAtomicas_local = 0;
+        long long reintentosCAS_local = 0;
+        long long robosStock_local = 0;
+
+        #pragma omp parallel num_threads(numThreads)
+        {
+            int tid = omp_get_thread_num();
+            ThreadStats ts;
+            EstadisticasHilo& miReparto = repartoHilos[tid];
+            AnilloTraza* anillo = anilloTraza(tid);
+            fijarHilo(tid, afinidad);
+            ubicacionActual(miReparto.cpu, miReparto.nodo);
+
+            if (modoStock == ModoStock::Fragmentado) {
+                MedicionFase medicion(perfilHw.get(), FASE_INVENTARIO, tid);
+                EventoTrazado evento(anillo, TRAZA_INVENTARIO);
+                repartirStockEnFragmentos(tid, omp_get_num_threads());
+                #pragma omp barrier
+            }
+
+            // Se reparte por lotes: cada hilo genera las cabeceras de su lote
+            // con SIMD y luego simula esos clientes uno a uno
+            LoteCabeceras lote;
+            AcumuladorEstadisticas acc;
+            auto simularLote = [&](int l, auto& stock) {
+                auto t0 = steady_clock::now();
+                int primerId = 1 + l * TAM_LOTE;
+                EventoTrazado eventoLote(anillo, TRAZA_LOTE, primerId);
+                int n = min(TAM_LOTE, numClientes - primerId + 1);
+                generarCabeceras(semilla, primerId, n, lote, nivelSimd, perfiles);
+                for (int k = 0; k < n; k++) {
+                    int i = primerId + k;
+                    EventoTrazado eventoCliente(anillo, TRAZA_CLIENTE, i);
+                    // Mismo flujo que en el modo secuencial: el carrito no depende del hilo
+                    philox::Flujo flujo(semilla, i, DOMINIO_CLIENTES, BLOQUE_LINEAS);
+                    Cliente c = simularClienteKernel(i, lote.cabecera(k, perfiles), inventario, flujo, stock, ts,
+                                                     arenas[tid], !modoStreaming);
+                    if (registro) registro->agregar(tid, c);
+                    if (modoStreaming) acc.agregar(c, inventario);
+                    else clientes[i-1] = c;
+                }
+                if (registro) registro->cerrarBloque(tid);
+                miReparto.ocupado += duration<double>(steady_clock::now() - t0).count();
+                miReparto.tareas++;
+            };
+
+            {
+                // Incluye la espera en la barrera del final del reparto
+                MedicionFase medicion(perfilHw.get(), FASE_GENERACION, tid);
+                EventoTrazado eventoReparto(anillo, TRAZA_REPARTO);
+                auto inicioReparto = steady_clock::now();
+                double ocupadoAntes = miReparto.ocupado;   // de los tramos anteriores
+                // La política de stock se fija aquí, una vez por hilo: el
+                // kernel queda instanciado para cada modo, sin decidir por línea
+                auto repartir = [&](auto stock) {
+                    if (planificacion == Planificacion::Robo) {
+                        int l;
+                        while (reparto.siguiente(tid, l, miReparto)) simularLote(desde + l, stock);
+                        #pragma omp barrier
+                    } else {
+                        #pragma omp for schedule(runtime)
+                        for (int l = desde; l < hasta; l++) simularLote(l, stock);
+                    }
+                };
+                switch (modoStock) {
+                    case ModoStock::Mutex:
+                        if (perfilLocks) {
+                            repartir(StockConMutexMedido{stockBloqueado.data(), perfilLocks->productos.data(),
+                                                         anillo, (uint32_t)perfilLocks->muestreo});
+                        } else {
+                            repartir(StockConMutex{stockBloqueado.data(), anillo});
+                        }
+                        break;
+                    case ModoStock::Atomico:
+                        repartir(StockAtomico{stockAtomico.data(), ts});
+                        break;
+                    case ModoStock::Fragmentado:
+                        repartir(StockFragmentado{fragmentos.data(), (int)fragmentos.size(), tid, ts});
+                        break;
+                }
+                miReparto.ocioso += duration<double>(steady_clock::now() - inicioReparto).count()
+                                 - (miReparto.ocupado - ocupadoAntes);
+            }
+
+            MedicionFase medicionAgregacion(perfilHw.get(), FASE_AGREGACION, tid);
+            EventoTrazado eventoAgregacion(anillo, TRAZA_AGREGACION);
+            #pragma omp atomic
+            ventasTotales_local += ts.ventasTotales;
+            #pragma omp atomic
+            productosVendidos_local += ts.productosVendidos;
+            #pragma omp atomic
+            pagosEfectivo_local += ts.pagosEfectivo;
+            #pragma omp atomic
+            pagosTarjeta_local += ts.pagosTarjeta;
+            #pragma omp atomic
+            reservasAtomicas_local += ts.reservasAtomicas;
+            #pragma omp atomic
+            reintentosCAS_local += ts.reintentosCAS;
+            #pragma omp atomic
+            robosStock_local += ts.robosStock;
+
+            if (modoStreaming) parciales[tid] = acc;
+
+            // Reconciliar: el reparto anterior ya terminó en todos los hilos
+            if (modoStock == ModoStock::Fragmentado) {
+                int numFragmentos = (int)fragmentos.size();
+                #pragma omp for schedule(static)
+                for (int p = 0; p < inventario.size(); p++) {
+                    int stockTotal = 0, vendidosTotal = 0;
+                    for (int f = 0; f < numFragmentos; f++) {
+                        stockTotal    += fragmentos[f].stock[p].load(memory_order_relaxed);
+                        vendidosTotal += fragmentos[f].vendidos[p];
+                    }
+                    inventario.stock[p]     = stockTotal;
+                    inventario.vendidos[p] += vendidosTotal;
+                }
+            }
+        }
+
+        {
+            MedicionFase medicion(perfilHw.get(), FASE_AGREGACION, 0);
+            EventoTrazado evento(anilloTraza(0), TRAZA_AGREGACION);
+            // Devolver los contadores atómicos o bloqueados al catálogo
+            if (modoStock == ModoStock::Atomico) {
+                for (int p = 0; p < inventario.size(); p++) {
+                    inventario.stock[p]    = stockAtomico[p].stock.load(memory_order_relaxed);
+                    inventario.vendidos[p] = stockAtomico[p].vendidos.load(memory_order_relaxed);
+                }
+            } else if (modoStock == ModoStock::Mutex) {
+                for (int p = 0; p < inventario.size(); p++) {
+                    inventario.stock[p]    = stockBloqueado[p].stock;
+                    inventario.vendidos[p] = stockBloqueado[p].vendidos;
+                }
+            }
+            for (const auto& p : parciales) acumulado.fusionar(p);
+        }
+
+        // Volcar a los miembros globales de la clase
+        ventasTotales     += ventasTotales_local;
+        productosVendidos += productosVendidos_local;
+        pagosEfectivo     += pagosEfectivo_local;
+        pagosTarjeta      += pagosTarjeta_local;
+        reservasAtomicas  += reservasAtomicas_local;
+        reintentosCAS     += reintentosCAS_local;
+        robosStock        += robosStock_local;
+    }
+
+    void ejecutarSimulacionOMP(int numClientes, int numThreads = 0,
+                               ModoStock modo = ModoStock::Mutex) {
+        if (numThreads <= 0) numThreads = omp_get_max_threads();
+        modoStock = modo;
+        hilosUsados = numThreads;
+
+        ThreadStats guardados;
+        long long siguienteId = restaurarInstantanea(2 + (int)modo, numClientes, guardados);
+        if (!reanudadoDesde) acumulado = AcumuladorEstadisticas();
+        else {
+            ventasTotales     = guardados.ventasTotales;
+            productosVendidos = guardados.productosVendidos;
+            pagosEfectivo     = guardados.pagosEfectivo;
+            pagosTarjeta      = guardados.pagosTarjeta;
+            reservasAtomicas  = guardados.reservasAtomicas;
+            reintentosCAS     = guardados.reintentosCAS;
+            robosStock        = guardados.robosStock;
+        }
+
+        if (verboso) {
+            cout << "\n=== INICIANDO SIMULACIÓN (OpenMP) ===" << endl;
+            cout << "Hilos: " << numThreads << " | Clientes: " << numClientes
+                 << " | Stock: " << (modo == ModoStock::Atomico     ? "atómico (CAS)"
+                                  : modo == ModoStock::Fragmentado ? "fragmentado por hilo"
+                                  : "mutex") << endl;
+            cout << "Semilla: " << semilla << " | Lotes: " << nombreNivelSimd(nivelSimd) << endl;
+            if (reanudadoDesde) cout << "Reanudando en el cliente " << reanudadoDesde << " (" << rutaInstantanea << ")" << endl;
+            cout << "----------------------------------------" << endl;
+        }
+
+        auto inicioSimulacion = high_resolution_clock::now();
+        if (perfilHw) perfilHw->preparar(numThreads);
+        if (traza) traza->preparar(numThreads);
+        if (perfilLocks) perfilLocks->preparar(modo == ModoStock::Mutex ? inventario.size() : 0);
+
+        analisis.listo = false;
+        clientes.clear();
+        if (!modoStreaming) clientes.resize(numClientes);
+        arenas = vector<ArenaLineas>(numThreads);
+        repartoHilos = vector<EstadisticasHilo>(numThreads);
+        if (registro) registro->preparar(numThreads);
+        long long reservasAntes = reservasAtomicas, reintentosAntes = reintentosCAS, robosAntes = robosStock;
+
+        // Estática, dinámica y guiada usan el 'omp for' con schedule(runtime);
+        // el robo usa colas propias (planificador.hpp). La planificación previa
+        // del runtime se restaura al salir.
+        int numLotes = (numClientes + TAM_LOTE - 1) / TAM_LOTE;
+        omp_sched_t schedAnterior;
+        int chunkAnterior;
+        omp_get_schedule(&schedAnterior, &chunkAnterior);
+        switch (planificacion) {
+            case Planificacion::Estatica: omp_set_schedule(omp_sched_static, 0); break;
+            case Planificacion::Dinamica: omp_set_schedule(omp_sched_dynamic, 1); break;
+            case Planificacion::Guiada:   omp_set_schedule(omp_sched_guided, 1); break;
+            case Planificacion::Robo:     break;
+        }
+
+        // Con instantáneas se simula por tramos: al final de cada uno el stock
+        // vuelve al catálogo y el estado queda quieto para guardarlo. Sin
+        // instantáneas hay un solo tramo con todos los lotes. Se redondea
+        // hacia arriba: una instantánea de una corrida terminada apunta a
+        // numClientes + 1, que puede caer a mitad del último lote.
+        int porTramo = clientesPorTramo > 0 ? lotesPorTramo() : max(numLotes, 1);
+        int primerLote = (int)((siguienteId - 1 + TAM_LOTE - 1) / TAM_LOTE);
+        for (int desde = primerLote; desde < numLotes; desde += porTramo) {
+            int hasta = min(numLotes, desde + porTramo);
+            simularTramoOMP(desde, hasta, numClientes, numThreads);
+            if (clientesPorTramo > 0) {
+                ThreadStats totales;
+                totales.ventasTotales     = ventasTotales;
+                totales.productosVendidos = productosVendidos;
+                totales.pagosEfectivo     = pagosEfectivo;
+                totales.pagosTarjeta      = pagosTarjeta;
+                totales.reservasAtomicas  = reservasAtomicas;
+                totales.reintentosCAS     = reintentosCAS;
+                totales.robosStock        = robosStock;
+                guardarInstantanea(2 + (int)modo, numClientes, min<long long>(numClientes, (long long)hasta * TAM_LOTE) + 1,
+                                   totales);
+            }
+        }
+
+        omp_set_schedule(schedAnterior, chunkAnterior);
+        if (perfilLocks) perfilLocks->cerrar();
+
+        auto finSimulacion = high_resolution_clock::now();
+        duration<double> duracionTotal = finSimulacion - inicioSimulacion;
+        tiempoSimulacion = duracionTotal.count();
+
+        if (!verboso) return;
+        long long reservas = reservasAtomicas - reservasAntes;
+        long long reintentos = reintentosCAS - reintentosAntes;
+        cout << "\nSimulación completada en " << fixed << setprecision(2)
+            << duracionTotal.count() << " segundos" << endl;
+        cout << "Memoria de clientes y carritos: " << memoriaClientesMB() << " MB" << endl;
+        if (modoStock == ModoStock::Atomico) {
+            cout << "Reintentos CAS: " << reintentos << " en "
+                 << reservas << " reservas ("
+                 << setprecision(3) << (reservas > 0 ? reintentos * 100.0 / reservas : 0.0)
+                 << "%)" << endl;
+        }
+        if (modoStock == ModoStock::Fragmentado) {
+            cout << "Robos entre fragmentos: " << robosStock - robosAntes
+                 << " | Reintentos CAS: " << reintentos << endl;
+        }
+        mostrarReparto();
+    }
+
+    // Lotes, tiempo ocupado y ocioso por hilo del último reparto paralelo.
+    // El desbalance es el hilo más ocupado sobre el promedio (1 = parejo).
+    void mostrarReparto() const {
+        if (repartoHilos.empty()) return;
+        double maximo = 0, suma = 0;
+        cout << "\n--- REPARTO DE LOTES (" << nombrePlanificacion(planificacion) << ") ---" << endl;
+        for (size_t h = 0; h < repartoHilos.size(); h++) {
+            const EstadisticasHilo& eh = repartoHilos[h];
+            cout << "Hilo " << right << setw(2) << h << " (cpu " << setw(3) << eh.cpu
+                 << ", nodo " << eh.nodo << "): " << setw(6) << eh.tareas << " lotes";
+            if (planificacion == Planificacion::Robo) cout << ", " << setw(4) << eh.robos << " robados";
+            cout << " | ocupado " << fixed << setprecision(4) << eh.ocupado
+                 << " s | ocioso " << eh.ocioso << " s" << endl;
+            maximo = max(maximo, eh.ocupado);
+            suma += eh.ocupado;
+        }
+        if (suma > 0) {
+            cout << "Desbalance: " << setprecision(3) << maximo * repartoHilos.size() / suma << endl;
+        }
+
+        const TopologiaNuma& topo = topologiaNuma();
+        cout << "Nodos NUMA: " << topo.numNodos() << " | Afinidad: "
+             << (afinidadDelRuntime() ? "del runtime (OMP_PROC_BIND)" : nombreAfinidad(afinidad)) << endl;
+        for (const ResumenNodo& rn : resumirPorNodo(repartoHilos)) {
+            cout << "Nodo " << rn.nodo << ": " << rn.hilos << " hilos, " << rn.tareas << " lotes"
+                 << " | ocupado " << setprecision(4) << rn.ocupado << " s | ocioso " << rn.ocioso << " s" << endl;
+        }
+    }
+
+    
+    // Calcula todo lo que muestran mostrarEstadisticas y mostrarInventarioFinal
+    // (agregados, top 10 y stock bajo) en paralelo, y lo mide aparte de la
+    // simulación.
+    void analizarResultados() {
+        auto inicio = high_resolution_clock::now();
+        
+        analisis.est = modoStreaming ? acumulado : agregarClientes();
+        
+        int n = inventario.size();
+        const int* vendidos = inventario.vendidos.data();
+        const int* stock = inventario.stock.data();
+        
+        if (perfilHw) perfilHw->preparar(omp_get_max_threads());
+        if (traza) traza->preparar(omp_get_max_threads());
+        
+        TopProductos top(10);
+        #pragma omp parallel reduction(fusionarTop : top)
+        {
+            MedicionFase medicion(perfilHw.get(), FASE_REPORTE, omp_get_thread_num());
+            EventoTrazado evento(anilloTraza(omp_get_thread_num()), TRAZA_REPORTE);
+            #pragma omp for schedule(static)
+            for (int p = 0; p < n; p++) {
+                if (vendidos[p] > 0) top.agregar(p, vendidos[p]);
+            }
+        }
+        analisis.top = top.ordenados();
+        
+        // Stock bajo: cada hilo filtra su tramo y se concatenan en orden de id
+        vector<vector<int>> bajos(omp_get_max_threads());
+        #pragma omp parallel
+        {
+            MedicionFase medicion(perfilHw.get(), FASE_REPORTE, omp_get_thread_num());
+            EventoTrazado evento(anilloTraza(omp_get_thread_num()), TRAZA_REPORTE);
+            vector<int>& propios = bajos[omp_get_thread_num()];
+            #pragma omp for schedule(static)
+            for (int p = 0; p < n; p++) {
+                if (stock[p] < 100) propios.push_back(p);
+            }
+        }
+        analisis.stockBajo.clear();
+        for (const auto& b : bajos) analisis.stockBajo.insert(analisis.stockBajo.end(), b.begin(), b.end());
+        
+        analisis.segundos = duration<double>(high_resolution_clock::now() - inicio).count();
+        analisis.listo = true;
+        
+        if (verboso) {
+            cout << "\nAnálisis completado en " << fixed << setprecision(4)
+                 << analisis.segundos << " segundos" << endl;
+        }
+    }
+    
+    double getTiempoAnalisis() const { return analisis.segundos; }
+    
+    // Resumen de la corrida para la salida JSON/CSV
+    void exportarResultados(Resultados& r) {
+        if (!analisis.listo) analizarResultados();
+        const AcumuladorEstadisticas& est = analisis.est;
+        r.agregar("semilla", (unsigned long long)semilla);
+        r.agregar("hilos", hilosUsados);
+        r.agregar("simd", nombreNivelSimd(nivelSimd));
+        r.agregar("streaming", modoStreaming ? 1 : 0);
+        if (traza) {
+            r.agregar("traza_eventos", (long long)traza->eventos());
+            r.agregar("traza_perdidos", (long long)traza->perdidos());
+        }
+        if (clientesPorTramo > 0) {
+            r.agregar("instantaneas", instantaneasEscritas);
+            r.agregar("reanudado_desde", reanudadoDesde);
+        }
+        r.agregar("tiempo_s", tiempoSimulacion, 9);
+        r.agregar("analisis_s", analisis.segundos, 9);
+        r.agregar("clientes_simulados", est.clientes);
+        r.agregar("ventas_totales", est.ventasTotales(), 2);
+        r.agregar("productos_vendidos", est.productosVendidos);
+        r.agregar("pagos_tarjeta", est.pagosTarjeta);
+        r.agregar("pagos_efectivo", est.pagosEfectivo);
+        r.agregar("tiempo_compra_medio_s", est.tiempoMedio, 3);
+        r.agregar("tiempo_compra_desviacion_s", est.tiempoDesviacion(), 3);
+        r.agregar("compradores_pequenos", est.compradores[0]);
+        r.agregar("compradores_medianos", est.compradores[1]);
+        r.agregar("compradores_grandes", est.compradores[2]);
+        r.agregar("compradores_mayoristas", est.compradores[3]);
+        r.agregar("perfiles", perfiles.n);
+        for (int t = 0; t < perfiles.n; t++)
+            r.agregar("perfil" + to_string(t) + "_clientes", est.porPerfil[t]);
+        r.agregar("productos_stock_bajo", (int)analisis.stockBajo.size());
+        r.agregar("reintentos_cas", reintentosCAS);
+        r.agregar("robos_stock", robosStock);
+        r.agregar("memoria_clientes_mb", memoriaClientesMB(), 3);
+        if (!repartoHilos.empty()) {
+            double maximo = 0, suma = 0, ocioso = 0;
+            long long robos = 0;
+            for (const auto& eh : repartoHilos) {
+                maximo = max(maximo, eh.ocupado);
+                suma += eh.ocupado;
+                ocioso += eh.ocioso;
+                robos += eh.robos;
+            }
+            r.agregar("planificacion", nombrePlanificacion(planificacion));
+            r.agregar("ocupado_max_s", maximo, 6);
+            r.agregar("ocupado_medio_s", suma / repartoHilos.size(), 6);
+            r.agregar("ocioso_total_s", ocioso, 6);
+            r.agregar("desbalance", suma > 0 ? maximo * repartoHilos.size() / suma : 1.0, 3);
+            r.agregar("lotes_robados", robos);
+            r.agregar("afinidad", afinidadDelRuntime() ? "runtime" : nombreAfinidad(afinidad));
+            r.agregar("nodos_numa", topologiaNuma().numNodos());
+            for (const ResumenNodo& rn : resumirPorNodo(repartoHilos)) {
+                string pre = "nodo" + to_string(rn.nodo) + "_";
+                r.agregar(pre + "hilos", rn.hilos);
+                r.agregar(pre + "lotes", rn.tareas);
+                r.agregar(pre + "ocupado_s", rn.ocupado, 6);
+            }
+        }
+        if (registro) {
+            r.agregar("registro_clientes", registro->clientes());
+            r.agregar("registro_lineas", registro->lineas());
+            r.agregar("registro_bytes", (unsigned long long)registro->bytesEscritos());
+            r.agregar("registro_espera_s", registro->segundosEspera(), 6);
+            r.agregar("registro_cierre_s", tiempoCierreRegistro, 6);
+        }
+        if (perfilHw) {
+            for (int f = 0; f < NUM_FASES; f++) {
+                LecturaHw t = perfilHw->totalFase(f);
+                string pre = string(nombreFase(f)) + "_";
+                r.agregar(pre + "ns", (unsigned long long)t.nanosegundos);
+                for (int e = 0; e < NUM_EVENTOS_HW; e++) {
+                    if (t.disponible[e]) r.agregar(pre + nombreEventoHw(e), (unsigned long long)t.valor[e]);
+                    else r.agregar(pre + nombreEventoHw(e), "n/d");
+                }
+            }
+        }
+        if (perfilLocks && !perfilLocks->productos.empty()) {
+            const PerfilLocks& pl = *perfilLocks;
+            ContencionProducto t = pl.total();
+            r.agregar("locks_muestreo", pl.muestreo);
+            r.agregar("locks_adquisiciones", (long long)pl.adquisiciones(t));
+            r.agregar("locks_contendidas", (long long)pl.contendidas(t));
+            r.agregar("locks_espera_ms", pl.esperaNs(t) / 1e6, 6);
+            r.agregar("locks_espera_p50_ns", pl.percentilNs(t, 50), 1);
+            r.agregar("locks_espera_p90_ns", pl.percentilNs(t, 90), 1);
+            r.agregar("locks_espera_p99_ns", pl.percentilNs(t, 99), 1);
+            vector<int> top = pl.masContendidos(5);
+            for (size_t k = 0; k < top.size(); k++) {
+                const ContencionProducto& c = pl.productos[top[k]];
+                string pre = "lock_top" + to_string(k + 1) + "_";
+                r.agregar(pre + "producto", string(inventario.nombre[top[k]]));
+                r.agregar(pre + "contendidas", (long long)pl.contendidas(c));
+                r.agregar(pre + "espera_ms", pl.esperaNs(c) / 1e6, 6);
+            }
+        }
+    }
+    
+    // Corre las cajas (simulacion_cajas.hpp) con los clientes ya simulados,
+    // en orden de id. En streaming no hay clientes guardados.
+    ResultadoCajas simularCajas(ConfigCajas cfgCajas) const {
+        if (modoStreaming)
+            throw logic_error("la simulación de cajas necesita los clientes guardados (sin streaming)");
+        cfgCajas.semilla = semilla;
+        long long n = (long long)clientes.size();
+        vector<ClienteCaja> entrada(n);
+        #pragma omp parallel for schedule(static)
+        for (long long i = 0; i < n; i++) {
+            const Cliente& c = clientes[i];
+            entrada[i].tiempoSeleccion = (float)(c.tiempoCompra - c.tiempoPago);
+            entrada[i].tiempoServicio  = (float)(c.tiempoPago + c.cantidadProductos * cfgCajas.segundosPorProducto);
+        }
+        return SimulacionCajas(cfgCajas).ejecutar(entrada);
+    }
+    
+    static void mostrarCajas(const ResultadoCajas& r) {
+        cout << "\n--- CAJAS (simulación de eventos discretos) ---" << endl;
+        cout << "Llegadas: " << fixed << setprecision(1) << r.llegadasPorHora << " clientes/hora"
+             << " | Jornada simulada: " << r.duracion / 3600.0 << " horas" << endl;
+        cout << "Espera en cola: media " << r.esperaMedia << " s | p50 " << setprecision(0) << r.esperaP50
+             << " s | p90 " << r.esperaP90 << " s | p95 " << r.esperaP95
+             << " s | p99 " << r.esperaP99 << " s | máx " << r.esperaMaxima << " s" << endl;
+        for (size_t c = 0; c < r.cajas.size(); c++) {
+            const EstadisticasCaja& ec = r.cajas[c];
+            cout << "Caja " << right << setw(2) << (c + 1) << ": " << setw(8) << ec.atendidos << " clientes | uso "
+                 << setprecision(1) << setw(5) << ec.utilizacion * 100 << "% | espera media "
+                 << setw(7) << ec.esperaMedia << " s | cola máx " << ec.colaMaxima << endl;
+        }
+        cout << "Eventos: " << r.eventos << " en " << setprecision(3) << r.segundosCpu << " s ("
+             << setprecision(1) << r.eventosPorSegundo / 1e6 << " M eventos/s)" << endl;
+    }
+    
+    static void exportarCajas(const ResultadoCajas& r, Resultados& res) {
+        res.agregar("cajas", (int)r.cajas.size());
+        res.agregar("llegadas_por_hora", r.llegadasPorHora, 3);
+        res.agregar("jornada_s", r.duracion, 3);
+        res.agregar("espera_media_s", r.esperaMedia, 3);
+        res.agregar("espera_p50_s", r.esperaP50, 0);
+        res.agregar("espera_p90_s", r.esperaP90, 0);
+        res.agregar("espera_p95_s", r.esperaP95, 0);
+        res.agregar("espera_p99_s", r.esperaP99, 0);
+        res.agregar("espera_max_s", r.esperaMaxima, 3);
+        for (size_t c = 0; c < r.cajas.size(); c++)
+            res.agregar("uso_caja" + to_string(c + 1), r.cajas[c].utilizacion, 4);
+        res.agregar("eventos", r.eventos);
+        res.agregar("eventos_por_segundo", r.eventosPorSegundo, 0);
+    }
+    
+    // Tabla de contadores por fase y por hilo (tiempos sumados entre hilos)
+    void mostrarContadores() const {
+        if (!perfilHw) return;
+        auto celda = [](const LecturaHw& l, int e) {
+            return l.disponible[e] ? to_string(l.valor[e]) : string("n/d");
+        };
+        cout << "\n--- CONTADORES DE HARDWARE POR FASE ---" << endl;
+        cout << left << setw(12) << "Fase" << setw(6) << "Hilo" << right << setw(12) << "ms"
+             << setw(16) << "ciclos" << setw(16) << "instrucciones" << setw(8) << "IPC"
+             << setw(14) << "fallos LLC" << setw(10) << "cambios" << endl;
+        for (int f = 0; f < NUM_FASES; f++) {
+            for (size_t h = 0; h <= perfilHw->porHilo.size(); h++) {
+                bool total = h == perfilHw->porHilo.size();
+                LecturaHw l = total ? perfilHw->totalFase(f) : perfilHw->porHilo[h][f];
+                if (l.nanosegundos == 0) continue;
+                if (total && perfilHw->porHilo.size() == 1) continue;
+                bool hayIpc = l.disponible[HW_CICLOS] && l.disponible[HW_INSTRUCCIONES] && l.valor[HW_CICLOS] > 0;
+                cout << left << setw(12) << nombreFase(f) << setw(6) << (total ? string("total") : to_string(h))
+                     << right << fixed << setprecision(3) << setw(12) << l.nanosegundos / 1e6
+                     << setw(16) << celda(l, HW_CICLOS) << setw(16) << celda(l, HW_INSTRUCCIONES)
+                     << setw(8) << (hayIpc ? to_string((double)l.valor[HW_INSTRUCCIONES] / l.valor[HW_CICLOS]).substr(0, 4) : string("n/d"))
+                     << setw(14) << celda(l, HW_FALLOS_LLC) << setw(10) << celda(l, HW_CAMBIOS_CONTEXTO) << endl;
+            }
+        }
+    }
+    
+    // Productos cuyo lock tuvo más espera en la última corrida en modo mutex
+    void mostrarContencion(int n = 10) const {
+        if (!perfilLocks || perfilLocks->productos.empty()) return;
+        const PerfilLocks& pl = *perfilLocks;
+        ContencionProducto t = pl.total();
+        cout << "\n--- CONTENCIÓN DE LOCKS POR PRODUCTO";
+        if (pl.muestreo > 1) cout << " (1 de cada " << pl.muestreo << " tomas, totales estimados)";
+        cout << " ---" << endl;
+        cout << fixed << setprecision(0) << "Tomas: " << pl.adquisiciones(t)
+             << " | contendidas: " << pl.contendidas(t) << " ("
+             << setprecision(3) << (t.adquisiciones > 0 ? t.contendidas * 100.0 / t.adquisiciones : 0.0)
+             << "%) | espera: " << pl.esperaNs(t) / 1e6 << " ms" << endl;
+        vector<int> top = pl.masContendidos(n);
+        if (top.empty()) return;
+        cout << left << setw(32) << "Producto" << right << setw(12) << "tomas" << setw(12) << "contendidas"
+             << setw(8) << "%" << setw(12) << "espera ms" << setw(10) << "p50 ns" << setw(10) << "p99 ns" << endl;
+        for (int p : top) {
+            const ContencionProducto& c = pl.productos[p];
+            cout << left << setw(32) << string(inventario.nombre[p]).substr(0, 31) << right << setprecision(0)
+                 << setw(12) << pl.adquisiciones(c) << setw(12) << pl.contendidas(c)
+                 << setprecision(2) << setw(8) << c.contendidas * 100.0 / c.adquisiciones
+                 << setprecision(3) << setw(12) << pl.esperaNs(c) / 1e6
+                 << setprecision(0) << setw(10) << pl.percentilNs(c, 50) << setw(10) << pl.percentilNs(c, 99) << endl;
+        }
+    }
+    
+    void mostrarEstadisticas() {
+        if (!analisis.listo) analizarResultados();
+        
+        cout << "\n\n========================================" << endl;
+        cout << "     ESTADÍSTICAS DE LA SIMULACIÓN      " << endl;
+        cout << "========================================" << endl;
+        
+        const AcumuladorEstadisticas& est = analisis.est;
+        long long totalClientes = est.clientes;
+        
+        // Calcular promedios
+        double promedioCompra = est.ventasTotales() / totalClientes;
+        tiempoPromedioCompra = est.tiempoMedio;
+        
+        cout << "\n--- VENTAS ---" << endl;
+        cout << "Total de clientes: " << totalClientes << endl;
+        cout << "Ventas totales: $" << fixed << setprecision(2) << est.ventasTotales() << endl;
+        cout << "Promedio por cliente: $" << promedioCompra << endl;
+        cout << "Productos vendidos: " << est.productosVendidos << endl;
+        cout << "Promedio productos/cliente: " << (double)est.productosVendidos/totalClientes << endl;
+        
+        cout << "\n--- MÉTODOS DE PAGO ---" << endl;
+        cout << "Pagos con tarjeta: " << est.pagosTarjeta 
+             << " (" << (est.pagosTarjeta*100.0/totalClientes) << "%)" << endl;
+        cout << "Pagos en efectivo: " << est.pagosEfectivo 
+             << " (" << (est.pagosEfectivo*100.0/totalClientes) << "%)" << endl;
+        
+        cout << "\n--- TIEMPOS ---" << endl;
+        cout << "Tiempo promedio de compra: " << fixed << setprecision(1) 
+             << tiempoPromedioCompra << " segundos (" 
+             << tiempoPromedioCompra/60.0 << " minutos)" << endl;
+        cout << "Desviación estándar: " << est.tiempoDesviacion() << " segundos | Mín: "
+             << est.tiempoMin << " | Máx: " << est.tiempoMax << endl;
+        
+        // Top 10 productos más vendidos
+        cout << "\n--- TOP 10 PRODUCTOS MÁS VENDIDOS ---" << endl;
+        for (size_t i = 0; i < analisis.top.size(); i++) {
+            cout << setw(2) << (i+1) << ". " << left << setw(25) 
+                 << inventario.nombre[analisis.top[i].producto] << " - " 
+                 << analisis.top[i].vendidos << " unidades" << endl;
+        }
+        
+        // Estadísticas por categoría, en orden alfabético
+        cout << "\n--- VENTAS POR CATEGORÍA ---" << endl;
+        vector<int> ordenCategorias(inventario.nombresCategoria.size());
+        for (size_t c = 0; c < ordenCategorias.size(); c++) ordenCategorias[c] = (int)c;
+        sort(ordenCategorias.begin(), ordenCategorias.end(), [&](int a, int b) {
+            return inventario.nombresCategoria[a] < inventario.nombresCategoria[b];
+        });
+        
+        for (int cat : ordenCategorias) {
+            if (est.unidadesPorCategoria[cat] == 0) continue;
+            cout << left << setw(15) << inventario.nombresCategoria[cat] << ": $" << fixed << setprecision(2) 
+                 << setw(10) << est.centavosPorCategoria[cat] / 100.0 << " (" << est.unidadesPorCategoria[cat] 
+                 << " productos)" << endl;
+        }
+        
+        // Distribución de tipos de compradores
+        cout << "\n--- DISTRIBUCIÓN DE COMPRADORES ---" << endl;
+        long long pequenos = est.compradores[0], medianos = est.compradores[1];
+        long long grandes = est.compradores[2], mayoristas = est.compradores[3];
+        
+        cout << "Compradores pequeños (1-5 productos): " << pequenos 
+             << " (" << (pequenos*100.0/totalClientes) << "%)" << endl;
+        cout << "Compradores medianos (6-15 productos): " << medianos 
+             << " (" << (medianos*100.0/totalClientes) << "%)" << endl;
+        cout << "Compradores grandes (16-30 productos): " << grandes 
+             << " (" << (grandes*100.0/totalClientes) << "%)" << endl;
+        cout << "Compradores mayoristas (>30 productos): " << mayoristas 
+             << " (" << (mayoristas*100.0/totalClientes) << "%)" << endl;
+        
+        cout << "\n--- PERFILES DE COMPRADOR ---" << endl;
+        for (int t = 0; t < perfiles.n; t++) {
+            cout << left << setw(20) << nombresPerfiles[t] << right << " (" << setw(3) << perfiles.minProductos[t]
+                 << "-" << setw(3) << perfiles.maxProductos[t] << " productos): " << est.porPerfil[t]
+                 << " (" << (est.porPerfil[t] * 100.0 / totalClientes) << "%)" << endl;
+        }
+        
+        cout << "\n========================================" << endl;
+    }
+    
+    void mostrarInventarioFinal() {
+        if (!analisis.listo) analizarResultados();
+        
+        cout << "\n--- ESTADO FINAL DEL INVENTARIO ---" << endl;
+        cout << "Productos con stock bajo (<100 unidades):" << endl;
+        
+        for (int p : analisis.stockBajo) {
+            cout << "- " << inventario.nombre[p] << ": " << inventario.stock[p] 
+                 << " unidades restantes" << endl;
+        }
+    }
+};
@@ -0,0 +1,330 @@
+#pragma once
+
+#include "simulador_supermercado.hpp"
+
+// Motor secuencial de referencia: mt19937 y stock ilimitado, sobre el mismo
+// kernel de cliente (simularClienteKernel) que el simulador principal, con
+// la política de stock sin sincronización. Lo único que cambia es el
+// generador y que la cabecera de cada cliente se sortea ahí mismo en vez de
+// por lotes con Philox. Vive en su propio namespace para poder compararlo en
+// el mismo proceso con el simulador de simulador_supermercado.hpp.
+namespace puro {
+
+// Adapta mt19937 a la interfaz de generador del kernel
+struct GeneradorMt {
+    mt19937 gen;
+    uint32_t siguiente() { return (uint32_t)gen(); }
+};
+
+// Clase principal del simulador
+class SimuladorSupermercado {
+private:
+    Catalogo inventario;
+    vector<Cliente> clientes;
+    ArenaLineas arena;
+    GeneradorMt generador;
+    TablaPerfiles perfiles = PERFILES_BASE;
+    
+    // Estadisticas globales (sumidero del kernel)
+    ThreadStats totales;
+    double tiempoPromedioCompra = 0;
+    
+    bool verboso = true;
+    double tiempoSimulacion = 0;
+    
+public:
+    SimuladorSupermercado() {
+        generador.gen.seed(random_device{}());
+        inicializarInventario();
+    }
+    
+    // Semilla fija: la misma semilla repite exactamente la corrida
+    explicit SimuladorSupermercado(uint64_t semilla) {
+        seed_seq seq{(uint32_t)semilla, (uint32_t)(semilla >> 32)};
+        generador.gen.seed(seq);
+        inicializarInventario();
+    }
+    
+    void setVerboso(bool activo) { verboso = activo; }
+    void setPerfiles(const vector<PerfilArchivo>& lista) { perfiles = tablaDePerfiles(lista); }
+    
+    double getTiempoSimulacion() const { return tiempoSimulacion; }
+    
+    void inicializarInventario() {
+        // 50 productos organizados por categorias con precios variados
+        vector<ProductoArchivo> productosData = {
+            // Frutas y Verduras (10 productos)
+            {"Manzanas (kg)", 2.50, "Frutas"},
+            {"Platanos (kg)", 1.80, "Frutas"},
+            {"Naranjas (kg)", 2.20, "Frutas"},
+            {"Tomates (kg)", 3.00, "Verduras"},
+            {"Lechuga", 1.50, "Verduras"},
+            {"Papas (kg)", 1.20, "Verduras"},
+            {"Zanahorias (kg)", 1.80, "Verduras"},
+            {"Cebolla (kg)", 1.50, "Verduras"},
+            {"Pimientos (kg)", 3.50, "Verduras"},
+            {"Aguacates", 4.00, "Frutas"},
+            
+            // Lacteos (8 productos)
+            {"Leche (1L)", 1.20, "Lacteos"},
+            {"Yogurt Natural", 2.50, "Lacteos"},
+            {"Queso Fresco", 5.50, "Lacteos"},
+            {"Mantequilla", 3.20, "Lacteos"},
+            {"Crema", 2.80, "Lacteos"},
+            {"Queso Mozzarella", 6.00, "Lacteos"},
+            {"Yogurt Griego", 3.50, "Lacteos"},
+            {"Leche Deslactosada", 1.80, "Lacteos"},
+            
+            // Carnes (8 productos)
+            {"Pollo (kg)", 8.50, "Carnes"},
+            {"Carne Molida (kg)", 12.00, "Carnes"},
+            {"Bistec (kg)", 18.00, "Carnes"},
+            {"Chuletas Cerdo (kg)", 15.00, "Carnes"},
+            {"Pescado Tilapia (kg)", 10.00, "Carnes"},
+            {"Salchichas", 4.50, "Carnes"},
+            {"Jamon (250g)", 5.00, "Carnes"},
+            {"Tocino", 7.50, "Carnes"},
+            
+            // Panaderia (6 productos)
+            {"Pan Blanco", 2.00, "Panaderia"},
+            {"Pan Integral", 2.50, "Panaderia"},
+            {"Croissants (3pz)", 3.50, "Panaderia"},
+            {"Tortillas (kg)", 1.50, "Panaderia"},
+            {"Pan Dulce", 2.80, "Panaderia"},
+            {"Galletas", 3.00, "Panaderia"},
+            
+            // Bebidas (8 productos)
+            {"Coca-Cola 2L", 2.50, "Bebidas"},
+            {"Agua 1L", 0.80, "Bebidas"},
+            {"Jugo Naranja 1L", 3.50, "Bebidas"},
+            {"Cerveza (6 pack)", 8.00, "Bebidas"},
+            {"Vino Tinto", 12.00, "Bebidas"},
+            {"Cafe Molido", 6.50, "Bebidas"},
+            {"Te Verde", 4.00, "Bebidas"},
+            {"Bebida Energetica", 3.00, "Bebidas"},
+            
+            // Abarrotes (10 productos)
+            {"Arroz (kg)", 2.20, "Abarrotes"},
+            {"Frijoles (kg)", 3.00, "Abarrotes"},
+            {"Pasta (500g)", 1.80, "Abarrotes"},
+            {"Aceite (1L)", 4.50, "Abarrotes"},
+            {"Azucar (kg)", 1.50, "Abarrotes"},
+            {"Sal (kg)", 0.80, "Abarrotes"},
+            {"Harina (kg)", 1.20, "Abarrotes"},
+            {"Cereal", 5.50, "Abarrotes"},
+            {"Salsa Tomate", 2.00, "Abarrotes"},
+            {"Mayonesa", 3.50, "Abarrotes"}
+        };
+        
+        cargarCatalogo(productosData);
+    }
+    
+    // Reemplaza el catalogo. Si el archivo no trae stock se usa el ilimitado
+    void cargarCatalogo(const vector<ProductoArchivo>& productosData) {
+        inventario.clear();
+        bool conPesos = false;
+        for (const auto& p : productosData) {
+            // Stock ilimitado simulado con un numero muy grande
+            inventario.agregar(p.nombre, p.precio, p.categoria, p.stock >= 0 ? p.stock : 999999999);
+            conPesos = conPesos || p.peso >= 0;
+        }
+        if (conPesos) {
+            vector<double> pesos;
+            for (const auto& p : productosData) pesos.push_back(p.peso >= 0 ? p.peso : 1.0);
+            inventario.asignarPesos(pesos);
+        }
+    }
+    
+    // Sortea la cabecera con mt19937 (misma tabla de perfiles que
+    // lote_clientes.hpp) y deja el carrito al kernel
+    Cliente simularCliente(int id) {
+        uniform_real_distribution<> probDist(0, 1);
+        mt19937& gen = generador.gen;
+        
+        CabeceraCliente cab;
+        double u = probDist(gen);
+        cab.tipo = elegirPerfil(perfiles, u);
+        uniform_int_distribution<> cantDist(perfiles.minProductos[cab.tipo], perfiles.maxProductos[cab.tipo]);
+        cab.productos = cantDist(gen);
+        cab.probProductoCaro = perfiles.probProductoCaro[cab.tipo];
+        
+        // Tiempo de pago; con tarjeta es mas rapido
+        cab.tarjeta = probDist(gen) < PROB_TARJETA;
+        cab.tiempoPago = uniform_real_distribution<>(PAGO_MIN, PAGO_MAX)(gen);
+        if (cab.tarjeta) cab.tiempoPago *= FACTOR_TARJETA;
+        cab.tiempoSeleccion = uniform_real_distribution<>(SELECCION_MIN, SELECCION_MAX)(gen);
+        
+        StockDirecto stock{inventario.stock.data(), inventario.vendidos.data()};
+        return simularClienteKernel(id, cab, inventario, generador, stock, totales, arena, true);
+    }
+    
+    void ejecutarSimulacion(int numClientes) {
+        if (verboso) {
+            cout << "\n=== INICIANDO SIMULACION DE SUPERMERCADO ===" << endl;
+            cout << "Simulando " << numClientes << " clientes..." << endl;
+            cout << "----------------------------------------" << endl;
+        }
+        
+        auto inicioSimulacion = high_resolution_clock::now();
+        
+        clientes.reserve(clientes.size() + numClientes);
+        for (int i = 1; i <= numClientes; i++) {
+            clientes.push_back(simularCliente(i));
+            
+            // Mostrar progreso cada 500 clientes (o cada 10000 si son muchos)
+            int intervalo = (numClientes > 10000) ? 10000 : 500;
+            if (verboso && i % intervalo == 0) {
+                cout << "Clientes procesados: " << i << "/" << numClientes << endl;
+            }
+        }
+        
+        auto finSimulacion = high_resolution_clock::now();
+        duration<double> duracionTotal = finSimulacion - inicioSimulacion;
+        tiempoSimulacion = duracionTotal.count();
+        
+        if (verboso) {
+            cout << "\nSimulacion completada en " << fixed << setprecision(2) 
+                 << duracionTotal.count() << " segundos" << endl;
+        }
+    }
+    
+    // Resumen de la corrida para la salida JSON/CSV
+    void exportarResultados(Resultados& r) const {
+        double tiempoTotal = 0;
+        for (const auto& c : clientes) tiempoTotal += c.tiempoCompra;
+        r.agregar("tiempo_s", tiempoSimulacion, 9);
+        r.agregar("clientes_simulados", (int)clientes.size());
+        r.agregar("ventas_totales", totales.ventasTotales, 2);
+        r.agregar("productos_vendidos", totales.productosVendidos);
+        r.agregar("pagos_tarjeta", totales.pagosTarjeta);
+        r.agregar("pagos_efectivo", totales.pagosEfectivo);
+        r.agregar("tiempo_compra_medio_s", clientes.empty() ? 0.0 : tiempoTotal / clientes.size(), 3);
+    }
+    
+    void mostrarEstadisticas() {
+        double ventasTotales = totales.ventasTotales;
+        long long productosVendidos = totales.productosVendidos;
+        long long pagosTarjeta = totales.pagosTarjeta, pagosEfectivo = totales.pagosEfectivo;
+        
+        cout << "\n\n========================================" << endl;
+        cout << "     ESTADISTICAS DE LA SIMULACION      " << endl;
+        cout << "========================================" << endl;
+        
+        // Calcular promedios
+        double promedioCompra = ventasTotales / clientes.size();
+        double tiempoTotal = 0;
+        for (const auto& c : clientes) {
+            tiempoTotal += c.tiempoCompra;
+        }
+        tiempoPromedioCompra = tiempoTotal / clientes.size();
+        
+        cout << "\n--- VENTAS ---" << endl;
+        cout << "Total de clientes: " << clientes.size() << endl;
+        cout << "Ventas totales: $" << fixed << setprecision(2) << ventasTotales << endl;
+        cout << "Promedio por cliente: $" << promedioCompra << endl;
+        cout << "Productos vendidos: " << productosVendidos << endl;
+        cout << "Promedio productos/cliente: " << (double)productosVendidos/clientes.size() << endl;
+        
+        cout << "\n--- METODOS DE PAGO ---" << endl;
+        cout << "Pagos con tarjeta: " << pagosTarjeta 
+             << " (" << (pagosTarjeta*100.0/clientes.size()) << "%)" << endl;
+        cout << "Pagos en efectivo: " << pagosEfectivo 
+             << " (" << (pagosEfectivo*100.0/clientes.size()) << "%)" << endl;
+        
+        cout << "\n--- TIEMPOS ---" << endl;
+        cout << "Tiempo promedio de compra: " << fixed << setprecision(1) 
+             << tiempoPromedioCompra << " segundos (" 
+             << tiempoPromedioCompra/60.0 << " minutos)" << endl;
+        
+        // Top 10 productos mas vendidos
+        cout << "\n--- TOP 10 PRODUCTOS MAS VENDIDOS ---" << endl;
+        vector<pair<string, int>> topProductos;
+        for (int p = 0; p < inventario.size(); p++) {
+            if (inventario.vendidos[p] > 0) {
+                topProductos.push_back(make_pair(string(inventario.nombre[p]), inventario.vendidos[p]));
+            }
+        }
+        
+        sort(topProductos.begin(), topProductos.end(), 
+             [](const pair<string, int>& a, const pair<string, int>& b) { 
+                 return a.second > b.second; 
+             });
+        
+        for (int i = 0; i < min(10, (int)topProductos.size()); i++) {
+            cout << setw(2) << (i+1) << ". " << left << setw(25) 
+                 << topProductos[i].first << " - " 
+                 << topProductos[i].second << " unidades" << endl;
+        }
+        
+        // Estadisticas por categoria
+        cout << "\n--- VENTAS POR CATEGORIA ---" << endl;
+        map<string, double> ventasPorCategoria;
+        map<string, int> productosPorCategoria;
+        
+        for (const auto& cliente : clientes) {
+            for (int j = 0; j < cliente.numLineas; j++) {
+                int prod = cliente.carrito[j].producto;
+                int cant = cliente.carrito[j].cantidad;
+                const string& categoria = inventario.nombresCategoria[inventario.categoria[prod]];
+                ventasPorCategoria[categoria] += inventario.precio[prod] * cant;
+                productosPorCategoria[categoria] += cant;
+            }
+        }
+        
+        for (map<string, double>::const_iterator it = ventasPorCategoria.begin(); 
+             it != ventasPorCategoria.end(); ++it) {
+            cout << left << setw(15) << it->first << ": $" << fixed << setprecision(2) 
+                 << setw(10) << it->second << " (" << productosPorCategoria[it->first] 
+                 << " productos)" << endl;
+        }
+        
+        // Distribucion de tipos de compradores
+        cout << "\n--- DISTRIBUCION DE COMPRADORES ---" << endl;
+        int pequenos = 0, medianos = 0, grandes = 0, mayoristas = 0;
+        
+        for (const auto& c : clientes) {
+            if (c.cantidadProductos <= 5) pequenos++;
+            else if (c.cantidadProductos <= 15) medianos++;
+            else if (c.cantidadProductos <= 30) grandes++;
+            else mayoristas++;
+        }
+        
+        cout << "Compradores pequenos (1-5 productos): " << pequenos 
+             << " (" << (pequenos*100.0/clientes.size()) << "%)" << endl;
+        cout << "Compradores medianos (6-15 productos): " << medianos 
+             << " (" << (medianos*100.0/clientes.size()) << "%)" << endl;
+        cout << "Compradores grandes (16-30 productos): " << grandes 
+             << " (" << (grandes*100.0/clientes.size()) << "%)" << endl;
+        cout << "Compradores mayoristas (>30 productos): " << mayoristas 
+             << " (" << (mayoristas*100.0/clientes.size()) << "%)" << endl;
+        
+        cout << "\n========================================" << endl;
+    }
+    
+    void mostrarInventarioFinal() {
+        cout << "\n--- RESUMEN DE INVENTARIO ---" << endl;
+        
+        // Mostrar total de unidades vendidas
+        long long totalUnidades = 0;
+        double ingresoTotal = 0;
+        
+        for (int p = 0; p < inventario.size(); p++) {
+            totalUnidades += inventario.vendidos[p];
+            ingresoTotal += inventario.vendidos[p] * inventario.precio[p];
+        }
+        
+        cout << "Total de unidades vendidas: " << totalUnidades << endl;
+        cout << "Ingresos totales calculados: $" << fixed << setprecision(2) << ingresoTotal << endl;
+        
+        // Mostrar productos menos vendidos (puede indicar falta de demanda)
+        cout << "\nProductos con menor demanda (<500 unidades vendidas):" << endl;
+        for (int p = 0; p < inventario.size(); p++) {
+            if (inventario.vendidos[p] < 500 && inventario.vendidos[p] > 0) {
+                cout << "- " << inventario.nombre[p] << ": " << inventario.vendidos[p] 
+                     << " unidades vendidas" << endl;
+            }
+        }
+    }
+};
+
+} // namespace puro
@@ -0,0 +1,199 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <x86intrin.h>
+#define TRAZA_RDTSC 1
+#endif
+
+#include "linea_cache.hpp"
+
+// Traza de la simulación en una línea de tiempo, para ver hilos rezagados y
+// tramos serializados (esperas de lock, barreras, fases de un solo hilo).
+//
+// Cada hilo anota sus eventos en su propio anillo: solo él escribe y nadie
+// lee hasta que termina la región paralela, así que anotar es guardar un
+// EventoTraza (24 bytes) sin atomics ni locks. Cuando el anillo se llena se
+// pisan los eventos más viejos (queda la última parte de la corrida). El
+// tiempo se toma con rdtsc donde existe y se pasa a microsegundos al
+// exportar, calibrando contra steady_clock desde que se creó la traza.
+//
+// Se exporta en el formato JSON de eventos de Chrome (chrome://tracing,
+// ui.perfetto.dev): un evento completo ("ph": "X") por intervalo, una fila
+// por hilo.
+
+enum TipoEventoTraza : uint16_t {
+    TRAZA_CLIENTE,          // un cliente entero (arg: id)
+    TRAZA_LOTE,             // cabeceras y clientes de un lote (arg: primer id)
+    TRAZA_ESPERA_LOCK,      // espera por el mutex de un producto (arg: producto)
+    TRAZA_REPARTO,          // reparto de lotes de un hilo, con la barrera final
+    TRAZA_INVENTARIO,       // copia o reparto del stock
+    TRAZA_AGREGACION,       // totales, fusión de parciales y reconciliación
+    TRAZA_REPORTE,          // top de productos y stock bajo
+    TRAZA_INSTANTANEA,      // escritura de una instantánea
+    NUM_TIPOS_TRAZA
+};
+
+inline const char* nombreEventoTraza(int t) {
+    static const char* nombres[NUM_TIPOS_TRAZA] = {
+        "cliente", "lote", "espera_lock", "reparto", "inventario", "agregacion", "reporte", "instantanea"
+    };
+    return nombres[t];
+}
+
+inline uint64_t ticksTraza() {
+#ifdef TRAZA_RDTSC
+    return __rdtsc();
+#else
+    return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+// Pasa ticks de ticksTraza() a tiempo, midiendo cuántos hubo contra
+// steady_clock desde reiniciar()
+struct CalibracionTicks {
+    uint64_t ticksOrigen = ticksTraza();
+    std::chrono::steady_clock::time_point relojOrigen = std::chrono::steady_clock::now();
+
+    void reiniciar() {
+        ticksOrigen = ticksTraza();
+        relojOrigen = std::chrono::steady_clock::now();
+    }
+
+    double ticksPorMicrosegundo() const {
+        double us = std::chrono::duration<double, std::micro>(
+            std::chrono::steady_clock::now() - relojOrigen).count();
+        double r = us > 0 ? (ticksTraza() - ticksOrigen) / us : 1.0;
+        return r > 0 ? r : 1.0;
+    }
+};
+
+struct EventoTraza {
+    uint64_t inicio;        // ticks
+    uint32_t duracion;      // ticks (saturado)
+    int32_t arg;
+    uint16_t tipo;
+};
+
+// Anillo de un hilo; la capacidad es potencia de 2
+struct alignas(TAM_LINEA_CACHE) AnilloTraza {
+    std::unique_ptr<EventoTraza[]> eventos;
+    uint64_t mascara = 0;
+    uint64_t escritos = 0;
+
+    void registrar(uint16_t tipo, uint64_t inicio, uint64_t fin, int32_t arg) {
+        EventoTraza& e = eventos[escritos & mascara];
+        uint64_t d = fin - inicio;
+        e.inicio = inicio;
+        e.duracion = d > UINT32_MAX ? UINT32_MAX : (uint32_t)d;
+        e.tipo = tipo;
+        e.arg = arg;
+        escritos++;
+    }
+
+    uint64_t guardados() const { return escritos < mascara + 1 ? escritos : mascara + 1; }
+    uint64_t perdidos() const { return escritos - guardados(); }
+};
+
+class Traza {
+public:
+    explicit Traza(size_t eventosPorHilo = 1 << 18) {
+        capacidad = 1;
+        while (capacidad < eventosPorHilo) capacidad <<= 1;
+    }
+
+    // Asegura un anillo por hilo; los que ya tienen eventos se conservan
+    void preparar(int numHilos) {
+        while ((int)anillos.size() < numHilos) {
+            anillos.emplace_back(new AnilloTraza());
+            AnilloTraza& a = *anillos.back();
+            a.eventos.reset(new EventoTraza[capacidad]);
+            a.mascara = capacidad - 1;
+        }
+    }
+
+    AnilloTraza* hilo(int h) { return h < (int)anillos.size() ? anillos[h].get() : nullptr; }
+
+    uint64_t eventos() const {
+        uint64_t n = 0;
+        for (const auto& a : anillos) n += a->guardados();
+        return n;
+    }
+
+    uint64_t perdidos() const {
+        uint64_t n = 0;
+        for (const auto& a : anillos) n += a->perdidos();
+        return n;
+    }
+
+    void escribirChrome(const std::string& ruta) const {
+        std::ofstream f(ruta);
+        if (!f) throw std::runtime_error("no se pudo crear la traza " + ruta);
+        escribirChrome(f);
+        if (!f) throw std::runtime_error("no se pudo escribir la traza " + ruta);
+    }
+
+    void escribirChrome(std::ostream& os) const {
+        // Ticks por microsegundo medidos sobre toda la corrida
+        double ticksPorUs = reloj.ticksPorMicrosegundo();
+
+        char buf[256];
+        os << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+        for (size_t h = 0; h < anillos.size(); h++) {
+            std::snprintf(buf, sizeof(buf),
+                          "%s\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%zu,"
+                          "\"args\":{\"name\":\"hilo %zu\"}}",
+                          h ? "," : "", h, h);
+            os << buf;
+        }
+        for (size_t h = 0; h < anillos.size(); h++) {
+            const AnilloTraza& a = *anillos[h];
+            uint64_t n = a.guardados();
+            for (uint64_t k = a.escritos - n; k < a.escritos; k++) {
+                const EventoTraza& e = a.eventos[k & a.mascara];
+                double ts = (double)(int64_t)(e.inicio - reloj.ticksOrigen) / ticksPorUs;
+                std::snprintf(buf, sizeof(buf),
+                              ",\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%zu,"
+                              "\"ts\":%.3f,\"dur\":%.3f,\"args\":{\"arg\":%d}}",
+                              nombreEventoTraza(e.tipo), h, ts, e.duracion / ticksPorUs, e.arg);
+                os << buf;
+            }
+        }
+        os << "\n]}\n";
+    }
+
+private:
+    size_t capacidad;
+    std::vector<std::unique_ptr<AnilloTraza>> anillos;
+    CalibracionTicks reloj;
+};
+
+// Anota un intervalo en el anillo mientras el objeto vive. Con anillo nulo
+// no lee el reloj, así el camino sin traza solo paga una comparación.
+class EventoTrazado {
+public:
+    EventoTrazado(AnilloTraza* anillo, uint16_t tipo, int32_t arg = 0)
+        : anillo(anillo), tipo(tipo), arg(arg), inicio(anillo ? ticksTraza() : 0) {}
+
+    ~EventoTrazado() {
+        if (anillo) anillo->registrar(tipo, inicio, ticksTraza(), arg);
+    }
+
+    EventoTrazado(const EventoTrazado&) = delete;
+    EventoTrazado& operator=(const EventoTrazado&) = delete;
+
+private:
+    AnilloTraza* anillo;
+    uint16_t tipo;
+    int32_t arg;
+    uint64_t inicio;
+};